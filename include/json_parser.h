@@ -3,6 +3,14 @@
 
 #include "jsonparser/json.h"
 #include "jsonparser/parser.h"
+#include "jsonparser/bind.h"
+#include "jsonparser/snapshot.h"
+#include "jsonparser/validator.h"
+#include "jsonparser/format.h"
+#include "jsonparser/schema.h"
+#include "jsonparser/reader.h"
+#include "jsonparser/query.h"
+#include "jsonparser/ndjson.h"
 
 namespace json_parser{
 
@@ -10,6 +18,10 @@ Json ParseJsonString(const std::string &json_string);
 Json ParseJsonString(const char *json_string);
 void ParseJsonString(const std::string &json_string, Json &json);
 void ParseJsonString(const char *json_string, Json &json);
+ParseResult TryParseJsonString(const std::string &json_string, Json &json) noexcept;
+ParseResult TryParseJsonString(const char *json_string, Json &json) noexcept;
+Json ParseJsonString(const std::string &json_string, ParseStats *stats);
+Json ParseJsonString(const char *json_string, ParseStats *stats);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+#ifndef BIND_H
+#define BIND_H
+
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "jsonparser/parser.h"
+
+namespace json_parser{
+
+//类型与Json文本之间的绑定，由特化提供Decode与Encode
+template<typename T>
+struct JsonBinder;
+
+template<>
+struct JsonBinder<int>{
+    static void Decode(Scanner &scanner, int &value);
+    static void Encode(const int &value, std::string &out);
+};
+
+template<>
+struct JsonBinder<double>{
+    static void Decode(Scanner &scanner, double &value);
+    static void Encode(const double &value, std::string &out);
+};
+
+template<>
+struct JsonBinder<bool>{
+    static void Decode(Scanner &scanner, bool &value);
+    static void Encode(const bool &value, std::string &out);
+};
+
+template<>
+struct JsonBinder<std::string>{
+    static void Decode(Scanner &scanner, std::string &value);
+    static void Encode(const std::string &value, std::string &out);
+};
+
+void ExpectToken(Scanner &scanner, JsonTokenType expected, const char *message);   //不匹配时抛出std::runtime_error
+void SkipValue(Scanner &scanner);
+
+//键的FNV-1a哈希，JSON_BIND以它在编译期生成switch分派字段；两个函数的结果必须一致
+constexpr unsigned long long BindFieldHash(const char *name, std::size_t length,
+                                           unsigned long long hash = 14695981039346656037ULL){
+    return length == 0 ? hash : BindFieldHash(name + 1, length - 1, (hash ^ (unsigned char)*name) * 1099511628211ULL);
+}
+
+inline unsigned long long BindKeyHash(const std::string &key){
+    unsigned long long hash = 14695981039346656037ULL;
+    for(std::string::size_type i = 0; i < key.size(); i++)
+        hash = (hash ^ (unsigned char)key[i]) * 1099511628211ULL;
+    return hash;
+}
+
+//逐个读取Json对象的键，on_field返回false表示该键未绑定，其值会被跳过
+template<typename F>
+void DecodeObject(Scanner &scanner, F on_field){
+    if(scanner.Scan() != JsonTokenType::BEGIN_OBJECT)
+        throw std::logic_error("type error: the type is not json object");
+    JsonTokenType token_type = scanner.Scan();
+    if(token_type == JsonTokenType::END_OBJECT)
+        return;
+    while(true){
+        if(token_type != JsonTokenType::VALUE_STRING)
+            throw std::runtime_error("format error: invalid json string, the key must be a string");
+        //键在下一个字符串被扫描前一直有效，无需拷贝
+        const std::string &key = scanner.get_string_value_quick();
+        ExpectToken(scanner, JsonTokenType::NAME_SEPARATOR, "format error: invalid json string, expected `:`");
+        if(!on_field(key))
+            SkipValue(scanner);
+
+        token_type = scanner.Scan();
+        if(token_type == JsonTokenType::END_OBJECT)
+            break;
+        if(token_type != JsonTokenType::VALUE_SEPARATOR)
+            throw std::runtime_error("format error: invalid json string, expected `,`");
+        token_type = scanner.Scan();
+    }
+}
+
+template<typename T>
+struct JsonBinder<std::vector<T>>{
+    static void Decode(Scanner &scanner, std::vector<T> &value){
+        if(scanner.Scan() != JsonTokenType::BEGIN_ARRAY)
+            throw std::logic_error("type error: the type is not json array");
+        value.clear();
+        if(scanner.Scan() == JsonTokenType::END_ARRAY)
+            return;
+        scanner.Rollback();
+        while(true){
+            value.emplace_back();
+            JsonBinder<T>::Decode(scanner, value.back());
+
+            JsonTokenType token_type = scanner.Scan();
+            if(token_type == JsonTokenType::END_ARRAY)
+                break;
+            if(token_type != JsonTokenType::VALUE_SEPARATOR)
+                throw std::runtime_error("format error: invalid json string, expected `,`");
+        }
+    }
+
+    static void Encode(const std::vector<T> &value, std::string &out){
+        out += '[';
+        for(auto it = value.begin(); it != value.end(); it++){
+            if(it != value.begin())
+                out += ',';
+            JsonBinder<T>::Encode(*it, out);
+        }
+        out += ']';
+    }
+};
+
+template<typename T>
+struct JsonBinder<std::map<std::string, T>>{
+    static void Decode(Scanner &scanner, std::map<std::string, T> &value){
+        value.clear();
+        DecodeObject(scanner, [&](const std::string &key) -> bool{
+            JsonBinder<T>::Decode(scanner, value[key]);
+            return true;
+        });
+    }
+
+    static void Encode(const std::map<std::string, T> &value, std::string &out){
+        out += '{';
+        for(auto it = value.begin(); it != value.end(); it++){
+            if(it != value.begin())
+                out += ',';
+            JsonBinder<std::string>::Encode(it->first, out);
+            out += ':';
+            JsonBinder<T>::Encode(it->second, out);
+        }
+        out += '}';
+    }
+};
+
+template<typename T>
+void Decode(const std::string &json_string, T &value){
+    Scanner scanner(json_string);
+    JsonBinder<T>::Decode(scanner, value);
+}
+
+template<typename T>
+T Decode(const std::string &json_string){
+    T value;
+    Decode(json_string, value);
+    return value;
+}
+
+template<typename T>
+void Encode(const T &value, std::string &out){
+    JsonBinder<T>::Encode(value, out);
+}
+
+template<typename T>
+std::string Encode(const T &value){
+    std::string out;
+    Encode(value, out);
+    return out;
+}
+}
+
+//为结构体生成JsonBinder特化，需在全局命名空间中使用，结构体名需带完整的命名空间
+//例如：JSON_BIND(app::User, id, name, tags)
+#define JSON_BIND(Struct, ...) \
+    namespace json_parser{ \
+    template<> \
+    struct JsonBinder<Struct>{ \
+        static void Decode(Scanner &scanner, Struct &value){ \
+            DecodeObject(scanner, [&](const std::string &key) -> bool{ \
+                switch(BindKeyHash(key)){ \
+                JSON_BIND_EACH(JSON_BIND_DECODE_FIELD, __VA_ARGS__) \
+                default: \
+                    break; \
+                } \
+                return false; \
+            }); \
+        } \
+        static void Encode(const Struct &value, std::string &out){ \
+            std::string::size_type begin = out.size(); \
+            JSON_BIND_EACH(JSON_BIND_ENCODE_FIELD, __VA_ARGS__) \
+            out[begin] = '{'; \
+            out += '}'; \
+        } \
+    }; \
+    }
+
+//先按哈希跳转，再比较一次键以排除碰撞；字段名的哈希相同时会因case重复而编译失败
+#define JSON_BIND_DECODE_FIELD(field) \
+    case BindFieldHash(#field, sizeof(#field) - 1): \
+        if(key == #field){ \
+            JsonBinder<decltype(value.field)>::Decode(scanner, value.field); \
+            return true; \
+        } \
+        break;
+
+//每个字段都以`,`开头，结束后将第一个`,`替换为`{`
+#define JSON_BIND_ENCODE_FIELD(field) \
+    out += ",\"" #field "\":"; \
+    JsonBinder<decltype(value.field)>::Encode(value.field, out);
+
+#define JSON_BIND_EXPAND(x) x
+#define JSON_BIND_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+#define JSON_BIND_EACH(action, ...) \
+    JSON_BIND_EXPAND(JSON_BIND_SELECT(__VA_ARGS__, \
+        JSON_BIND_EACH32, JSON_BIND_EACH31, JSON_BIND_EACH30, JSON_BIND_EACH29, JSON_BIND_EACH28, JSON_BIND_EACH27, JSON_BIND_EACH26, JSON_BIND_EACH25, \
+        JSON_BIND_EACH24, JSON_BIND_EACH23, JSON_BIND_EACH22, JSON_BIND_EACH21, JSON_BIND_EACH20, JSON_BIND_EACH19, JSON_BIND_EACH18, JSON_BIND_EACH17, \
+        JSON_BIND_EACH16, JSON_BIND_EACH15, JSON_BIND_EACH14, JSON_BIND_EACH13, JSON_BIND_EACH12, JSON_BIND_EACH11, JSON_BIND_EACH10, JSON_BIND_EACH9, \
+        JSON_BIND_EACH8, JSON_BIND_EACH7, JSON_BIND_EACH6, JSON_BIND_EACH5, JSON_BIND_EACH4, JSON_BIND_EACH3, JSON_BIND_EACH2, JSON_BIND_EACH1)(action, __VA_ARGS__))
+#define JSON_BIND_EACH1(action, x) action(x)
+#define JSON_BIND_EACH2(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH1(action, __VA_ARGS__))
+#define JSON_BIND_EACH3(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH2(action, __VA_ARGS__))
+#define JSON_BIND_EACH4(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH3(action, __VA_ARGS__))
+#define JSON_BIND_EACH5(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH4(action, __VA_ARGS__))
+#define JSON_BIND_EACH6(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH5(action, __VA_ARGS__))
+#define JSON_BIND_EACH7(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH6(action, __VA_ARGS__))
+#define JSON_BIND_EACH8(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH7(action, __VA_ARGS__))
+#define JSON_BIND_EACH9(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH8(action, __VA_ARGS__))
+#define JSON_BIND_EACH10(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH9(action, __VA_ARGS__))
+#define JSON_BIND_EACH11(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH10(action, __VA_ARGS__))
+#define JSON_BIND_EACH12(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH11(action, __VA_ARGS__))
+#define JSON_BIND_EACH13(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH12(action, __VA_ARGS__))
+#define JSON_BIND_EACH14(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH13(action, __VA_ARGS__))
+#define JSON_BIND_EACH15(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH14(action, __VA_ARGS__))
+#define JSON_BIND_EACH16(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH15(action, __VA_ARGS__))
+#define JSON_BIND_EACH17(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH16(action, __VA_ARGS__))
+#define JSON_BIND_EACH18(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH17(action, __VA_ARGS__))
+#define JSON_BIND_EACH19(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH18(action, __VA_ARGS__))
+#define JSON_BIND_EACH20(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH19(action, __VA_ARGS__))
+#define JSON_BIND_EACH21(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH20(action, __VA_ARGS__))
+#define JSON_BIND_EACH22(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH21(action, __VA_ARGS__))
+#define JSON_BIND_EACH23(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH22(action, __VA_ARGS__))
+#define JSON_BIND_EACH24(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH23(action, __VA_ARGS__))
+#define JSON_BIND_EACH25(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH24(action, __VA_ARGS__))
+#define JSON_BIND_EACH26(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH25(action, __VA_ARGS__))
+#define JSON_BIND_EACH27(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH26(action, __VA_ARGS__))
+#define JSON_BIND_EACH28(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH27(action, __VA_ARGS__))
+#define JSON_BIND_EACH29(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH28(action, __VA_ARGS__))
+#define JSON_BIND_EACH30(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH29(action, __VA_ARGS__))
+#define JSON_BIND_EACH31(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH30(action, __VA_ARGS__))
+#define JSON_BIND_EACH32(action, x, ...) action(x) JSON_BIND_EXPAND(JSON_BIND_EACH31(action, __VA_ARGS__))
+
+#endif
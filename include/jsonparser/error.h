@@ -0,0 +1,40 @@
+#ifndef ERROR_H
+#define ERROR_H
+
+namespace json_parser{
+
+enum class ErrorCode
+{
+    OK,
+    UNEXPECTED_END,
+    INVALID_VALUE,
+    INVALID_TRUE,
+    INVALID_FALSE,
+    INVALID_NULL,
+    INVALID_NUMBER,
+    INVALID_STRING,     //字符串中含有未转义的控制字符
+    INVALID_ESCAPE,
+    INVALID_UTF8,
+    MISSING_QUOTE,
+    EXPECTED_KEY,
+    EXPECTED_COLON,
+    EXPECTED_COMMA,
+    TRAILING_CHARACTERS,
+    DEPTH_EXCEEDED,
+    OUT_OF_MEMORY,
+};
+
+const char *ErrorMessage(ErrorCode code);
+
+//不抛出异常的解析与校验接口的返回值
+struct ParseResult{
+    ErrorCode error;
+    unsigned long offset;   //出错记号的字节偏移，成功时为已读取的字节数
+
+    explicit operator bool() const{
+        return error == ErrorCode::OK;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <string>
+
+namespace json_parser{
+
+//直接在Json文本上重新排版，不构建Json对象，字符串与数字按原样输出
+//只检查字符串是否闭合，Prettify还会检查括号是否配对，完整的语法检查请先使用Validate
+
+//去除字符串之外的空白字符，结果追加到output末尾或写入文件描述符fd
+std::string Minify(const std::string &json);
+void Minify(const char *json, unsigned long length, std::string &output);
+void Minify(const char *json, unsigned long length, int fd);
+
+//每层缩进indent个空格，空的Json对象与Json数组输出为`{}`与`[]`
+std::string Prettify(const std::string &json, unsigned indent = 4);
+void Prettify(const char *json, unsigned long length, std::string &output, unsigned indent = 4);
+void Prettify(const char *json, unsigned long length, int fd, unsigned indent = 4);
+}
+
+#endif
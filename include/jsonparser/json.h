@@ -5,6 +5,8 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include "jsonparser/memory_resource.h"
+#include "jsonparser/ref_ptr.h"
 
 namespace json_parser{
 enum class JsonType
@@ -19,11 +21,48 @@ enum class JsonType
     JSON_OBJECT,
 };
 
+//一段连续存储的只读数值，数组被修改或重新解析后失效
+template<typename T>
+class NumberSpan{
+public:
+    NumberSpan() : data_(nullptr), size_(0){}
+    NumberSpan(const T *data, unsigned long size) : data_(data), size_(size){}
+
+    const T *data() const{
+        return data_;
+    }
+    unsigned long size() const{
+        return size_;
+    }
+    bool empty() const{
+        return size_ == 0;
+    }
+    const T *begin() const{
+        return data_;
+    }
+    const T *end() const{
+        return data_ + size_;
+    }
+    const T &operator[](unsigned long index) const{
+        return data_[index];
+    }
+
+private:
+    const T *data_;
+    unsigned long size_;
+};
 
 class Json{
 public:
+    //Json数组的元素连续存储，迭代器即指针
+    typedef Json *iterator;
+    typedef const Json *const_iterator;
+    class ObjectItems;
+    class ConstObjectItems;
+
     Json();
     Json(JsonType type);
+    Json(JsonType type, MemoryResource *resource);  //字符串与容器从resource中申请
     Json(int value);
     Json(double value);
     Json(bool value);
@@ -34,14 +73,15 @@ public:
 
     ~Json();
 
-    operator bool();
-    operator int();
-    operator double();
-    operator std::string();
+    operator bool() const;
+    operator int() const;
+    operator double() const;
+    operator std::string() const;
     void operator=(const Json & other);
 
     void Clone(const Json &other);
     void Copy(const Json &other);
+    void Copy(const Json &other, MemoryResource *resource);    //逐层拷贝到resource中，不与other共享任何容器
     void Append(const Json &other);
 
     void Remove(int index);
@@ -57,16 +97,40 @@ public:
 
     unsigned long Size() const;
 
+    //遍历Json数组，不是Json数组时抛出异常；非const版本与非const的[]相同，数组被共享时先复制一份
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    //按键的顺序遍历Json对象的键值对，不是Json对象时抛出异常；键为原文，不解码转义
+    ObjectItems Items();
+    ConstObjectItems Items() const;
+
     Json &operator[](int index);
     Json &operator[](const std::string &key);
     Json &operator[](const char* key);
+    const Json &operator[](int index) const;
+    const Json &operator[](const std::string &key) const;  //键不存在时抛出异常，不会插入
+    const Json &operator[](const char* key) const;
 
     bool operator==(const Json &other) const;
     bool operator!=(const Json &other) const;
     bool Equal(const Json &other) const;
     Json CopySelf() const;
     unsigned long UseCount();
-    std::string ToJsonString();
+    unsigned long MemoryUsage() const;  //整棵树占用的堆内存，共享的容器只计算一次
+    std::string ToJsonString() const;
+    //输出与ToJsonString相同，容器会缓存各自的文本，再次输出时未修改的子树直接复用缓存
+    //修改沿非const的[]、Append、Insert、Remove进行时，只有从根到修改处的容器需要重新输出
+    std::string ToCachedJsonString() const;
+    std::shared_ptr<const Json> Freeze() const;    //深拷贝出一份只读快照
+    unsigned long Hash() const;     //结构哈希，Equal的值哈希一定相同，容器的哈希会被缓存
+    void Deduplicate();     //将结构相同的子树合并为同一块共享内存
+
+    //返回应用补丁后的新文档，只复制被修改路径上的容器，其余部分与原文档共享
+    Json ApplyPatch(const Json &patch) const;       //RFC 6902 Json Patch
+    Json ApplyMergePatch(const Json &patch) const;  //RFC 7386 Json Merge Patch
+    Json Diff(const Json &target) const;    //生成将自身变为target的Json Patch
     
     //类型判断
     bool IsNull() const;
@@ -80,19 +144,103 @@ public:
 
     JsonType get_type() const;
 
+    //只含数字的数组可以被解析器紧凑存储，见Parser::set_pack_numeric_arrays
+    JsonType GetPackedType() const;     //紧凑存储时返回JSON_INT或JSON_DOUBLE，否则返回JSON_NULL
+    NumberSpan<int> GetIntSpan() const;
+    NumberSpan<double> GetDoubleSpan() const;
+    MemoryResource *GetMemoryResource() const;  //字符串与容器所在的内存资源，其他类型返回默认资源
+
 private:
+    friend class Schema;
+    friend class Parser;
+
+    struct StringBuffer;
+    struct ArrayBuffer;
+    struct ObjectBuffer;
+
+    enum class PatchMode{
+        ADD,
+        REMOVE,
+        REPLACE,
+    };
+
+    void CopyContainer(const Json &other, MemoryResource *resource);
+    void DeepCopy(const Json &other, MemoryResource *resource);
+    void AppendJsonString(std::string &output, bool cached) const;
+    const Json &Resolve(const std::vector<std::string> &path) const;
+    Json PatchPath(const std::vector<std::string> &path, unsigned long depth,
+                   PatchMode mode, const Json &value) const;
+    void Detach();
+    void DiffInto(const Json &target, const std::string &path, Json &patch) const;
+    void DiffArray(const Json &target, const std::string &path, Json &patch) const;
+
     struct Value{
         int int_value;
         double double_value;
         bool bool_value;
-        std::shared_ptr<std::string> string_value;
-        std::shared_ptr<std::vector<Json>> array_value;
-        std::shared_ptr<std::map<std::string,Json>> object_value;
+        RefPtr<StringBuffer> string_value;
+        RefPtr<ArrayBuffer> array_value;
+        RefPtr<ObjectBuffer> object_value;
     };
 
     struct Value value_;
     JsonType type_;
 };
+
+typedef std::vector<Json, PolymorphicAllocator<Json>> JsonVector;
+typedef std::map<std::string, Json, std::less<std::string>,
+                 PolymorphicAllocator<std::pair<const std::string, Json>>> JsonMap;
+
+//Json对象的键值对视图，元素为std::pair<const std::string, Json>，对象被修改后失效
+class Json::ObjectItems{
+public:
+    typedef JsonMap::iterator iterator;
+
+    ObjectItems(iterator first, iterator last, unsigned long size) : first_(first), last_(last), size_(size){}
+
+    iterator begin() const{
+        return first_;
+    }
+    iterator end() const{
+        return last_;
+    }
+    unsigned long size() const{
+        return size_;
+    }
+    bool empty() const{
+        return size_ == 0;
+    }
+
+private:
+    iterator first_;
+    iterator last_;
+    unsigned long size_;
+};
+
+class Json::ConstObjectItems{
+public:
+    typedef JsonMap::const_iterator iterator;
+
+    ConstObjectItems(iterator first, iterator last, unsigned long size) : first_(first), last_(last), size_(size){}
+
+    iterator begin() const{
+        return first_;
+    }
+    iterator end() const{
+        return last_;
+    }
+    unsigned long size() const{
+        return size_;
+    }
+    bool empty() const{
+        return size_ == 0;
+    }
+
+private:
+    iterator first_;
+    iterator last_;
+    unsigned long size_;
+};
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef MEMORY_RESOURCE_H
+#define MEMORY_RESOURCE_H
+
+#include <cstddef>
+
+namespace json_parser{
+
+//仿照C++17的std::pmr::memory_resource，Json的容器与字符串缓冲区从内存资源中申请
+//字符串的字符数据与Json对象的键由std::string的默认分配器申请，不经过内存资源
+class MemoryResource{
+public:
+    static const std::size_t kMaxAlign = alignof(std::max_align_t);
+
+    virtual ~MemoryResource();
+
+    void *Allocate(std::size_t bytes, std::size_t alignment = kMaxAlign){
+        return DoAllocate(bytes, alignment);
+    }
+    void Deallocate(void *p, std::size_t bytes, std::size_t alignment = kMaxAlign){
+        DoDeallocate(p, bytes, alignment);
+    }
+    bool IsEqual(const MemoryResource &other) const noexcept{
+        return this == &other || DoIsEqual(other);
+    }
+
+protected:
+    virtual void *DoAllocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void DoDeallocate(void *p, std::size_t bytes, std::size_t alignment) = 0;
+    virtual bool DoIsEqual(const MemoryResource &other) const noexcept = 0;
+};
+
+MemoryResource *NewDeleteResource() noexcept;      //使用全局的operator new与operator delete
+MemoryResource *GetDefaultMemoryResource() noexcept;
+MemoryResource *SetDefaultMemoryResource(MemoryResource *resource) noexcept;   //返回之前的资源，nullptr表示NewDeleteResource
+
+//只增不减的内存资源，Deallocate不做任何事，Release或析构时一次性归还给上游
+//适合为单个请求解析的Json提供内存，请求结束后整体丢弃
+class MonotonicBufferResource : public MemoryResource{
+public:
+    explicit MonotonicBufferResource(std::size_t initial_size = 4096,
+                                     MemoryResource *upstream = GetDefaultMemoryResource());
+    MonotonicBufferResource(void *buffer, std::size_t size,
+                            MemoryResource *upstream = GetDefaultMemoryResource());    //先使用外部提供的缓冲区
+    ~MonotonicBufferResource();
+
+    MonotonicBufferResource(const MonotonicBufferResource &) = delete;
+    MonotonicBufferResource &operator=(const MonotonicBufferResource &) = delete;
+
+    void Release();
+    MemoryResource *upstream() const;
+
+protected:
+    void *DoAllocate(std::size_t bytes, std::size_t alignment);
+    void DoDeallocate(void *p, std::size_t bytes, std::size_t alignment);
+    bool DoIsEqual(const MemoryResource &other) const noexcept;
+
+private:
+    struct Chunk{
+        Chunk *next;
+        std::size_t size;
+    };
+
+    MemoryResource *upstream_;
+    Chunk *chunks_;
+    void *initial_buffer_;
+    std::size_t initial_size_;
+    std::size_t next_size_;
+    char *current_;
+    std::size_t available_;
+};
+
+//仿照std::pmr::polymorphic_allocator，使标准容器从MemoryResource中申请内存
+template<typename T>
+class PolymorphicAllocator{
+public:
+    typedef T value_type;
+
+    PolymorphicAllocator() noexcept
+        : resource_(GetDefaultMemoryResource()){}
+    PolymorphicAllocator(MemoryResource *resource) noexcept
+        : resource_(resource){}
+    template<typename U>
+    PolymorphicAllocator(const PolymorphicAllocator<U> &other) noexcept
+        : resource_(other.resource()){}
+
+    T *allocate(std::size_t n){
+        return static_cast<T *>(resource_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *p, std::size_t n){
+        resource_->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    //与std::pmr一致，拷贝容器时不传播内存资源
+    PolymorphicAllocator select_on_container_copy_construction() const{
+        return PolymorphicAllocator();
+    }
+
+    MemoryResource *resource() const{
+        return resource_;
+    }
+
+private:
+    MemoryResource *resource_;
+};
+
+template<typename T, typename U>
+bool operator==(const PolymorphicAllocator<T> &a, const PolymorphicAllocator<U> &b){
+    return a.resource()->IsEqual(*b.resource());
+}
+
+template<typename T, typename U>
+bool operator!=(const PolymorphicAllocator<T> &a, const PolymorphicAllocator<U> &b){
+    return !(a == b);
+}
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef NDJSON_H
+#define NDJSON_H
+
+#include <functional>
+#include <string>
+#include "jsonparser/json.h"
+#include "jsonparser/parser.h"
+#include "jsonparser/reader.h"
+
+namespace json_parser{
+
+//逐行解析NDJSON（每行一个Json文本），只缓存当前的一行，内存占用与输入的总长度无关
+//同一个对象可以反复使用，解析器与Json的缓冲区会被复用
+class NdjsonParser{
+public:
+    typedef std::function<void(const Json &value)> Callback;
+
+    NdjsonParser();
+
+    //按行的顺序对每个值调用callback，返回值的数量；空白行被跳过，某一行格式错误或值后还有非空白字符时抛出std::runtime_error
+    //传给callback的值在下一行被解析时会被覆盖，需要保留时请拷贝
+    unsigned long Run(ChunkReader &reader, const Callback &callback);
+    unsigned long Run(const std::string &text, const Callback &callback);
+
+private:
+    void Emit(const Callback &callback);
+
+    Parser parser_;
+    Json value_;
+    std::string line_;
+    unsigned long count_;
+};
+}
+
+#endif
@@ -2,7 +2,9 @@
 #define PARSER_H
 
 #include <string>
+#include <vector>
 #include "jsonparser/json.h"
+#include "jsonparser/error.h"
 
 namespace json_parser{
 
@@ -27,12 +29,36 @@ enum class JsonTokenType
     END_OF_FILE    //EOF
 };
 
+//解析统计信息，只有在定义了JSON_PARSER_STATS的情况下编译库时才会被记录
+//同一个对象被多次使用时各项累加，max_depth取最大值，需要时调用Reset清零
+struct ParseStats{
+    ParseStats();
+
+    void Reset();
+    unsigned long TokenCount(JsonTokenType type) const;
+    static bool Enabled();  //库是否启用了统计
+
+    unsigned long bytes_consumed;
+    unsigned long token_counts[static_cast<int>(JsonTokenType::END_OF_FILE) + 1];
+    unsigned long max_depth;
+    unsigned long string_bytes;
+    unsigned long number_count;
+    unsigned long allocations;      //近似值，按容器与字符串的堆内存块计算
+    unsigned long bytes_allocated;
+
+    double scan_seconds;    //词法扫描耗时
+    double build_seconds;   //构建Json对象耗时
+    double total_seconds;
+};
+
 class Scanner{
 public:
+    Scanner();
     Scanner(const char* json_string);
     Scanner(const std::string &json_string);
 
-    JsonTokenType Scan();
+    JsonTokenType Scan();   //格式错误时抛出std::runtime_error
+    JsonTokenType Scan(ErrorCode &error);   //格式错误时返回END_OF_FILE并设置error，不抛出异常
 
     bool get_bool_value() const;
     double get_number_value() const;
@@ -40,14 +66,18 @@ public:
     const std::string &get_string_value_quick() const;
 
     void Rollback();    //状态回滚
+    void Reset(const std::string &json_string);    //更换输入，保留已申请的内存
+    void Reset(const char *json_string);
+    unsigned long get_position() const;
+    unsigned long get_token_position() const;   //最近一个记号的起始位置
 
 private:
     bool IsEnd();
     char Advance();
-    void ScanTrue();
-    void ScanFalse();
-    void ScanNull();
-    void ScanString();
+    bool ScanTrue();
+    bool ScanFalse();
+    bool ScanNull();
+    bool ScanString();
     void ScanNumber();
 
     bool IsDigit(char c);
@@ -65,19 +95,41 @@ private:
     bool value_bool_;
 };
 
+//Parser可以长期持有并反复使用，每个线程一个。Reset更换输入后，扫描缓冲区与内部的栈都会被保留；
+//Parse(Json&)解析到已有的对象中，原地复用其独占的字符串与容器，共享的部分会重新申请
 class Parser{
 public:
+    Parser();
     Parser(const std::string &json_string);
     Parser(const char *json_string);
+    Parser(const std::string &json_string, ParseStats *stats);
+    Parser(const char *json_string, ParseStats *stats);
+    void Reset(const std::string &json_string);
+    void Reset(const char *json_string);
     Json Parse();
+    void Parse(Json &json);
+    ParseResult TryParse(Json &json) noexcept;  //不抛出异常，以错误码与字节偏移表示格式错误，失败时json为null
+    void set_memory_resource(MemoryResource *resource);    //之后解析出的字符串与容器从resource分配（字符数据除外），nullptr表示默认资源
+    MemoryResource *get_memory_resource() const;
+    void set_pack_numeric_arrays(bool pack);    //只含数字的数组紧凑存储为int或double，默认关闭
+    bool get_pack_numeric_arrays() const;
 
 private:
-    Json ParseObject();
-    Json ParseArray();
-    
+    bool ParseValue(JsonTokenType token_type, Json &json);
+    bool ParseObject(Json &json);
+    bool ParseArray(Json &json);
+    JsonTokenType Scan();
+    bool Fail(ErrorCode code);
 
 private:
     Scanner scanner_;
+    ParseStats *stats_;
+    unsigned long depth_;
+    JsonTokenType last_token_;
+    ErrorCode error_;
+    std::vector<const Json *> seen_;    //解析Json对象时出现过的值
+    MemoryResource *resource_;
+    bool pack_numbers_;
 };
 }
 
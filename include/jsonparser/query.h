@@ -0,0 +1,44 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "jsonparser/json.h"
+#include "jsonparser/reader.h"
+
+namespace json_parser{
+
+//在Json文本上流式求值路径表达式，不构建整棵树，内存占用只与路径长度和匹配值的大小有关
+//支持`$`、`.key`、`['key']`、`[index]`、`.*`与`[*]`，例如`$.events[*].user.id`
+//不在路径上的值只做括号匹配后跳过，不检查其内部的语法；匹配的值会被完整解析
+class PathQuery{
+public:
+    typedef std::function<void(const Json &value)> Callback;
+
+    explicit PathQuery(const std::string &expression);  //表达式不合法时抛出std::logic_error
+
+    //按文档顺序对每个匹配的值调用callback，返回匹配的数量；文本格式错误时抛出std::runtime_error
+    unsigned long Run(ChunkReader &reader, const Callback &callback) const;
+    unsigned long Run(const std::string &json_string, const Callback &callback) const;
+
+private:
+    enum class StepType{
+        KEY,
+        INDEX,
+        WILDCARD,
+    };
+
+    struct Step{
+        StepType type;
+        std::string key;
+        unsigned long index;
+    };
+
+    class Evaluator;
+
+    std::vector<Step> steps_;
+};
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef READER_H
+#define READER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace json_parser{
+
+//按块提供输入，Read返回的数据在下一次调用Read之前有效
+class ChunkReader{
+public:
+    virtual ~ChunkReader();
+    virtual unsigned long Read(const char *&data) = 0;  //返回块的长度，0表示输入结束
+};
+
+//将一段内存按chunk_size切分，内存由调用者持有
+class MemoryChunkReader : public ChunkReader{
+public:
+    MemoryChunkReader(const char *data, unsigned long length, unsigned long chunk_size = 1 << 20);
+    explicit MemoryChunkReader(const std::string &data, unsigned long chunk_size = 1 << 20);
+
+    unsigned long Read(const char *&data);
+
+private:
+    const char *data_;
+    unsigned long length_;
+    unsigned long pos_;
+    unsigned long chunk_size_;
+};
+
+//以read读取文件描述符，不关闭fd
+class FdChunkReader : public ChunkReader{
+public:
+    explicit FdChunkReader(int fd, unsigned long buffer_size = 1 << 20);
+
+    unsigned long Read(const char *&data);
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+};
+
+#ifndef _WIN32
+//以mmap映射整个文件，按块顺序交出，已读过的页会被归还，常驻内存不随文件大小增长
+//依赖POSIX的mmap与madvise，Windows上不提供，请改用FdChunkReader
+class MappedFileReader : public ChunkReader{
+public:
+    explicit MappedFileReader(const std::string &path, unsigned long chunk_size = 1 << 24);
+    MappedFileReader(const MappedFileReader &) = delete;
+    MappedFileReader &operator=(const MappedFileReader &) = delete;
+    ~MappedFileReader();
+
+    unsigned long Read(const char *&data);
+    unsigned long size() const;
+
+private:
+    int fd_;
+    char *data_;
+    unsigned long size_;
+    unsigned long pos_;
+    unsigned long released_;    //已归还的字节数，按页对齐
+    unsigned long chunk_size_;
+};
+#endif
+
+//在后台线程中以zlib解压gzip（或zlib）格式的输入，解压与读者的解析同时进行
+//解压出的数据按chunk_size分块，经过ring_size个槽位的环形缓冲区交给读者，内存占用与解压后的大小无关
+//构建时未启用JSON_PARSER_ZLIB时，构造函数抛出std::runtime_error
+class GzipChunkReader : public ChunkReader{
+public:
+    explicit GzipChunkReader(const std::string &path, unsigned long chunk_size = 1 << 18, unsigned long ring_size = 8);
+    explicit GzipChunkReader(int fd, unsigned long chunk_size = 1 << 18, unsigned long ring_size = 8);  //不关闭fd
+    GzipChunkReader(const GzipChunkReader &) = delete;
+    GzipChunkReader &operator=(const GzipChunkReader &) = delete;
+    ~GzipChunkReader();
+
+    unsigned long Read(const char *&data);  //压缩数据损坏或被截断时抛出std::runtime_error
+
+private:
+    class Pipeline;
+
+    std::unique_ptr<Pipeline> pipeline_;
+};
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef REF_PTR_H
+#define REF_PTR_H
+
+namespace json_parser{
+
+//侵入式引用计数的智能指针，计数保存在T中，由T::Retain、T::Release与T::RefCount维护
+//接收裸指针时接管其已有的一次引用
+template<typename T>
+class RefPtr{
+public:
+    RefPtr() noexcept : ptr_(nullptr){}
+    explicit RefPtr(T *ptr) noexcept : ptr_(ptr){}
+    RefPtr(const RefPtr &other) noexcept : ptr_(other.ptr_){
+        if(ptr_)
+            ptr_->Retain();
+    }
+    RefPtr(RefPtr &&other) noexcept : ptr_(other.ptr_){
+        other.ptr_ = nullptr;
+    }
+    ~RefPtr(){
+        if(ptr_)
+            ptr_->Release();
+    }
+
+    RefPtr &operator=(const RefPtr &other) noexcept{
+        if(ptr_ != other.ptr_)  //已指向同一缓冲区时不改动计数
+            RefPtr(other).swap(*this);
+        return *this;
+    }
+    RefPtr &operator=(RefPtr &&other) noexcept{
+        RefPtr(static_cast<RefPtr &&>(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(RefPtr &other) noexcept{
+        T *ptr = ptr_;
+        ptr_ = other.ptr_;
+        other.ptr_ = ptr;
+    }
+
+    T *get() const noexcept{
+        return ptr_;
+    }
+    T &operator*() const noexcept{
+        return *ptr_;
+    }
+    T *operator->() const noexcept{
+        return ptr_;
+    }
+    explicit operator bool() const noexcept{
+        return ptr_ != nullptr;
+    }
+    unsigned long use_count() const noexcept{
+        return ptr_ ? ptr_->RefCount() : 0;
+    }
+
+private:
+    T *ptr_;
+};
+
+template<typename T>
+bool operator==(const RefPtr<T> &a, const RefPtr<T> &b) noexcept{
+    return a.get() == b.get();
+}
+
+template<typename T>
+bool operator!=(const RefPtr<T> &a, const RefPtr<T> &b) noexcept{
+    return a.get() != b.get();
+}
+}
+
+#endif
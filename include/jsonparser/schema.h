@@ -0,0 +1,45 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include "jsonparser/json.h"
+
+namespace json_parser{
+
+struct SchemaResult{
+    bool valid;
+    std::string path;       //未通过校验的值的Json Pointer
+    std::string message;
+
+    explicit operator bool() const{
+        return valid;
+    }
+};
+
+//将JSON Schema（draft 2020-12的子集）编译为校验程序，编译后不可修改，可在多个线程中共享
+//支持type、required、properties、items、enum、pattern，以及minimum、maximum、
+//exclusiveMinimum、exclusiveMaximum、minLength、maxLength、minItems、maxItems、
+//minProperties、maxProperties，其余关键字被忽略
+class Schema{
+public:
+    explicit Schema(const Json &schema);    //Schema不合法时抛出std::logic_error
+
+    SchemaResult Validate(const Json &json) const;
+    //边扫描边校验Json文本，不构建Json对象，遇到第一个错误即停止；文本格式错误时抛出std::runtime_error
+    SchemaResult ValidateText(const std::string &json_string) const;
+
+private:
+    struct Node;
+    struct Program;
+
+    //直接访问Json的内部缓冲区，避免拷贝
+    static const Json::ObjectBuffer &Members(const Json &json);
+    static const std::string &Text(const Json &json);
+
+    std::shared_ptr<const Program> program_;
+};
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <memory>
+#include "jsonparser/json.h"
+
+namespace json_parser{
+
+typedef std::shared_ptr<const Json> JsonSnapshot;
+
+//原子地持有一份只读快照，读者取得快照后无需加锁即可访问，
+//发布新快照不会影响正在读取旧快照的线程，旧快照在最后一个读者释放后销毁
+class SnapshotHolder{
+public:
+    SnapshotHolder();
+    explicit SnapshotHolder(const JsonSnapshot &snapshot);
+
+    SnapshotHolder(const SnapshotHolder &) = delete;
+    SnapshotHolder &operator=(const SnapshotHolder &) = delete;
+
+    JsonSnapshot Load() const;
+    void Publish(const JsonSnapshot &snapshot);
+    void Publish(const Json &json);     //冻结后发布
+    JsonSnapshot Exchange(const JsonSnapshot &snapshot);
+    bool CompareExchange(JsonSnapshot &expected, const JsonSnapshot &desired);
+
+private:
+    JsonSnapshot snapshot_;
+};
+}
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef STATIC_JSON_H
+#define STATIC_JSON_H
+
+#if __cplusplus < 201703L
+#error "static_json.h requires C++17, link the JsonParserStatic target"
+#endif
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "jsonparser/json.h"
+#include "jsonparser/error.h"
+
+namespace json_parser{
+
+//编译期解析出的一个值，整棵树按先序连续存储
+struct StaticNode{
+    JsonType type = JsonType::JSON_NULL;
+    bool bool_value = false;
+    int int_value = 0;
+    double double_value = 0;
+    std::string_view string_value;  //字符串的原文，与Json一致不解码转义
+    std::string_view key;           //在所在Json对象中的键，数组元素与根为空
+    std::size_t size = 0;           //容器的元素个数
+    std::size_t end = 0;            //子树之后的下一个节点
+};
+
+//constexpr的解析器，词法与Scanner一致：数字不支持指数，字符串只跳过转义而不检查，空白为空格、\t、\n、\r
+//nodes为空时只校验并计数；格式错误时抛出std::runtime_error，在常量求值中即为编译错误
+class StaticParser{
+public:
+    constexpr StaticParser(std::string_view text, StaticNode *nodes = nullptr, std::size_t capacity = 0)
+        : text_(text), pos_(0), nodes_(nodes), capacity_(capacity), count_(0){}
+
+    //返回节点的数量
+    constexpr std::size_t Parse(){
+        ParseValue(std::string_view());
+        SkipWhitespace();
+        if(pos_ != text_.size())
+            throw std::runtime_error(ErrorMessage(ErrorCode::TRAILING_CHARACTERS));
+        return count_;
+    }
+
+private:
+    static constexpr bool IsDigit(char c){
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr char Peek() const{
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    //读取下一个字节，输入已结束时报错
+    constexpr char Next(){
+        if(pos_ >= text_.size())
+            throw std::runtime_error(ErrorMessage(ErrorCode::UNEXPECTED_END));
+        return text_[pos_++];
+    }
+
+    constexpr void SkipWhitespace(){
+        while(pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                      text_[pos_] == '\n' || text_[pos_] == '\r'))
+            ++pos_;
+    }
+
+    constexpr bool Consume(std::string_view literal){
+        if(text_.substr(pos_, literal.size()) != literal)
+            return false;
+        pos_ += literal.size();
+        return true;
+    }
+
+    constexpr std::size_t Append(JsonType type, std::string_view key){
+        std::size_t index = count_++;
+        if(nodes_ && index >= capacity_)
+            throw std::logic_error("range error: the node count does not match");
+        if(nodes_){
+            nodes_[index].type = type;
+            nodes_[index].key = key;
+            nodes_[index].end = count_;
+        }
+        return index;
+    }
+
+    constexpr void ParseValue(std::string_view key){
+        SkipWhitespace();
+        char c = Next();
+        switch(c){
+        case '{':
+            ParseObject(key);
+            break;
+        case '[':
+            ParseArray(key);
+            break;
+        case '\"':{
+            std::size_t index = Append(JsonType::JSON_STRING, key);
+            std::string_view value = ScanString();
+            if(nodes_){
+                nodes_[index].string_value = value;
+                nodes_[index].size = value.size();
+            }
+            break;
+        }
+        case 't':
+        case 'f':{
+            if(!Consume(c == 't' ? "rue" : "alse"))
+                throw std::runtime_error(ErrorMessage(c == 't' ? ErrorCode::INVALID_TRUE : ErrorCode::INVALID_FALSE));
+            std::size_t index = Append(JsonType::JSON_BOOL, key);
+            if(nodes_)
+                nodes_[index].bool_value = c == 't';
+            break;
+        }
+        case 'n':
+            if(!Consume("ull"))
+                throw std::runtime_error(ErrorMessage(ErrorCode::INVALID_NULL));
+            Append(JsonType::JSON_NULL, key);
+            break;
+        default:
+            if(c != '-' && !IsDigit(c))
+                throw std::runtime_error(ErrorMessage(ErrorCode::INVALID_VALUE));
+            ScanNumber(c, key);
+            break;
+        }
+    }
+
+    //pos_位于`"`之后，转义字符之后的一个字节总是被跳过
+    constexpr std::string_view ScanString(){
+        std::size_t begin = pos_;
+        while(pos_ < text_.size() && text_[pos_] != '\"')
+            pos_ += text_[pos_] == '\\' ? 2 : 1;
+        if(pos_ >= text_.size())
+            throw std::runtime_error(ErrorMessage(ErrorCode::MISSING_QUOTE));
+        return text_.substr(begin, pos_++ - begin);
+    }
+
+    //有效数字不超过2^53且小数位数不超过22时只做一次舍入，与运行时的atof结果相同；
+    //更长的数字以long double计算，在极少数情况下可能相差最低位
+    constexpr void ScanNumber(char first, std::string_view key){
+        bool negative = first == '-';
+        std::uint64_t mantissa = negative ? 0 : first - '0';
+        int scale = 0;      //十进制指数，溢出的整数位为正，小数位为负
+        while(IsDigit(Peek())){
+            if(mantissa < UINT64_MAX / 10)
+                mantissa = mantissa * 10 + (text_[pos_] - '0');
+            else
+                ++scale;
+            ++pos_;
+        }
+        if(Peek() == '.' && pos_ + 1 < text_.size() && IsDigit(text_[pos_ + 1])){
+            ++pos_;
+            while(IsDigit(Peek())){
+                if(mantissa < UINT64_MAX / 10){
+                    mantissa = mantissa * 10 + (text_[pos_] - '0');
+                    --scale;
+                }
+                ++pos_;
+            }
+        }
+
+        long double power = 1;
+        for(int i = scale < 0 ? -scale : scale; i > 0; i--)
+            power *= 10;
+        double value = 0;
+        if(mantissa <= (std::uint64_t(1) << 53) && scale >= -22 && scale <= 22)
+            value = scale >= 0 ? mantissa * static_cast<double>(power) : mantissa / static_cast<double>(power);
+        else
+            value = static_cast<double>(scale >= 0 ? mantissa * power : mantissa / power);
+        if(negative)
+            value = -value;
+
+        //与Parser一致，整数值的数字为JSON_INT；超出int范围时保留为JSON_DOUBLE
+        bool integral = scale >= 0 || value == static_cast<double>(static_cast<std::int64_t>(value));
+        if(integral && value >= INT_MIN && value <= INT_MAX){
+            std::size_t index = Append(JsonType::JSON_INT, key);
+            if(nodes_)
+                nodes_[index].int_value = static_cast<int>(value);
+        }else{
+            std::size_t index = Append(JsonType::JSON_DOUBLE, key);
+            if(nodes_)
+                nodes_[index].double_value = value;
+        }
+    }
+
+    constexpr void ParseArray(std::string_view key){
+        std::size_t index = Append(JsonType::JSON_ARRAY, key);
+        std::size_t size = 0;
+        SkipWhitespace();
+        if(Peek() == ']'){
+            ++pos_;
+        }else{
+            while(true){
+                ParseValue(std::string_view());
+                ++size;
+                SkipWhitespace();
+                char c = Next();
+                if(c == ']')
+                    break;
+                if(c != ',')
+                    throw std::runtime_error(ErrorMessage(ErrorCode::EXPECTED_COMMA));
+            }
+        }
+        Close(index, size);
+    }
+
+    constexpr void ParseObject(std::string_view key){
+        std::size_t index = Append(JsonType::JSON_OBJECT, key);
+        std::size_t size = 0;
+        SkipWhitespace();
+        if(Peek() == '}'){
+            ++pos_;
+        }else{
+            while(true){
+                SkipWhitespace();
+                if(Next() != '\"')
+                    throw std::runtime_error(ErrorMessage(ErrorCode::EXPECTED_KEY));
+                std::string_view member = ScanString();
+                SkipWhitespace();
+                if(Next() != ':')
+                    throw std::runtime_error(ErrorMessage(ErrorCode::EXPECTED_COLON));
+                ParseValue(member);
+                ++size;
+                SkipWhitespace();
+                char c = Next();
+                if(c == '}')
+                    break;
+                if(c != ',')
+                    throw std::runtime_error(ErrorMessage(ErrorCode::EXPECTED_COMMA));
+            }
+        }
+        Close(index, size);
+    }
+
+    constexpr void Close(std::size_t index, std::size_t size){
+        if(nodes_){
+            nodes_[index].size = size;
+            nodes_[index].end = count_;
+        }
+    }
+
+    std::string_view text_;
+    std::size_t pos_;
+    StaticNode *nodes_;
+    std::size_t capacity_;
+    std::size_t count_;
+};
+
+constexpr std::size_t StaticNodeCount(std::string_view text){
+    return StaticParser(text).Parse();
+}
+
+//StaticDocument中一个值的只读视图，接口与Json的const接口对应，可以在常量表达式中使用
+//Json对象按文本中的顺序保存，键重复时与Parser一致以后出现的为准
+class StaticJson{
+public:
+    class Iterator{
+    public:
+        constexpr Iterator(const StaticNode *nodes, std::size_t index) : nodes_(nodes), index_(index){}
+
+        constexpr StaticJson operator*() const{
+            return StaticJson(nodes_, index_);
+        }
+        constexpr Iterator &operator++(){
+            index_ = nodes_[index_].end;
+            return *this;
+        }
+        constexpr bool operator==(const Iterator &other) const{
+            return index_ == other.index_;
+        }
+        constexpr bool operator!=(const Iterator &other) const{
+            return index_ != other.index_;
+        }
+
+    private:
+        const StaticNode *nodes_;
+        std::size_t index_;
+    };
+
+    constexpr StaticJson(const StaticNode *nodes, std::size_t index) : nodes_(nodes), index_(index){}
+
+    constexpr JsonType get_type() const{
+        return Node().type;
+    }
+    constexpr bool IsNull() const{
+        return get_type() == JsonType::JSON_NULL;
+    }
+    constexpr bool IsInt() const{
+        return get_type() == JsonType::JSON_INT;
+    }
+    constexpr bool IsDouble() const{
+        return get_type() == JsonType::JSON_DOUBLE;
+    }
+    constexpr bool IsBool() const{
+        return get_type() == JsonType::JSON_BOOL;
+    }
+    constexpr bool IsNumber() const{
+        return IsInt() || IsDouble();
+    }
+    constexpr bool IsString() const{
+        return get_type() == JsonType::JSON_STRING;
+    }
+    constexpr bool IsArray() const{
+        return get_type() == JsonType::JSON_ARRAY;
+    }
+    constexpr bool IsObject() const{
+        return get_type() == JsonType::JSON_OBJECT;
+    }
+
+    constexpr operator bool() const{
+        if(!IsBool())
+            throw std::logic_error("type error: the type is not bool");
+        return Node().bool_value;
+    }
+    constexpr operator int() const{
+        if(!IsInt())
+            throw std::logic_error("type error: the type is not int");
+        return Node().int_value;
+    }
+    constexpr operator double() const{
+        if(!IsDouble())
+            throw std::logic_error("type error: the type is not double");
+        return Node().double_value;
+    }
+    constexpr operator std::string_view() const{
+        if(!IsString())
+            throw std::logic_error("type error: the type is not string");
+        return Node().string_value;
+    }
+
+    constexpr std::string_view get_key() const{    //所在Json对象中的键
+        return Node().key;
+    }
+
+    constexpr unsigned long Size() const{
+        if(!IsArray() && !IsObject() && !IsString())
+            throw std::logic_error("type error: unsupport the method for this type");
+        return Node().size;
+    }
+
+    //遍历Json数组的元素或Json对象的值，Json对象的键由get_key取得
+    constexpr Iterator begin() const{
+        if(!IsArray() && !IsObject())
+            throw std::logic_error("type error: the type is not json array or json object");
+        return Iterator(nodes_, index_ + 1);
+    }
+    constexpr Iterator end() const{
+        return Iterator(nodes_, Node().end);
+    }
+
+    constexpr StaticJson operator[](int index) const{
+        if(!IsArray())
+            throw std::logic_error("type error: the type is not json array");
+        if(index < 0)
+            throw std::logic_error("range error: the index cannot less than 0");
+        if((unsigned long)index >= Node().size)
+            throw std::logic_error("range error: the index out of range");
+        Iterator it = begin();
+        for(; index > 0; index--)
+            ++it;
+        return *it;
+    }
+
+    constexpr StaticJson operator[](std::string_view key) const{
+        std::size_t found = Find(key);
+        if(found == 0)
+            throw std::logic_error("range error: the key does not exist");
+        return StaticJson(nodes_, found);
+    }
+
+    constexpr StaticJson operator[](const char *key) const{
+        return (*this)[std::string_view(key)];
+    }
+
+    constexpr bool FindKey(std::string_view key) const{
+        return Find(key) != 0;
+    }
+
+    //转换为运行时的Json，字符串与键按原文复制
+    Json ToJson() const{
+        switch(get_type()){
+        case JsonType::JSON_BOOL:
+            return Json(Node().bool_value);
+        case JsonType::JSON_INT:
+            return Json(Node().int_value);
+        case JsonType::JSON_DOUBLE:
+            return Json(Node().double_value);
+        case JsonType::JSON_STRING:
+            return Json(std::string(Node().string_value));
+        case JsonType::JSON_ARRAY:{
+            Json json(JsonType::JSON_ARRAY);
+            for(StaticJson element : *this)
+                json.Append(element.ToJson());
+            return json;
+        }
+        case JsonType::JSON_OBJECT:{
+            Json json(JsonType::JSON_OBJECT);
+            for(StaticJson member : *this)
+                json.Insert(std::string(member.get_key()), member.ToJson());
+            return json;
+        }
+        default:
+            return Json();
+        }
+    }
+
+private:
+    constexpr const StaticNode &Node() const{
+        return nodes_[index_];
+    }
+
+    //返回最后一个匹配的节点，不存在时返回0（根不会是成员）
+    constexpr std::size_t Find(std::string_view key) const{
+        if(!IsObject())
+            throw std::logic_error("type error: the type is not json object");
+        std::size_t found = 0;
+        for(std::size_t index = index_ + 1; index < Node().end; index = nodes_[index].end){
+            if(nodes_[index].key == key)
+                found = index;
+        }
+        return found;
+    }
+
+    const StaticNode *nodes_;
+    std::size_t index_;
+};
+
+//编译期解析得到的只读文档，N为节点的数量，通常由JSON_STATIC宏推导
+//需要以constexpr的静态变量保存，StaticJson视图引用其中的节点
+template<std::size_t N>
+class StaticDocument{
+public:
+    constexpr explicit StaticDocument(std::string_view text) : nodes_(){
+        if(StaticNodeCount(text) != N)     //先完整校验，格式错误优先于数量不符报告
+            throw std::logic_error("range error: the node count does not match");
+        StaticParser(text, nodes_, N).Parse();
+    }
+
+    constexpr StaticJson Root() const{
+        return StaticJson(nodes_, 0);
+    }
+
+    constexpr StaticJson operator[](int index) const{
+        return Root()[index];
+    }
+    constexpr StaticJson operator[](std::string_view key) const{
+        return Root()[key];
+    }
+
+    Json ToJson() const{
+        return Root().ToJson();
+    }
+
+private:
+    StaticNode nodes_[N];
+};
+}
+
+//在编译期解析Json字符串字面量，格式错误时编译失败
+//例如 static constexpr auto kConfig = JSON_STATIC(R"({"port":8080})");
+#define JSON_STATIC(text) ::json_parser::StaticDocument<::json_parser::StaticNodeCount(text)>(text)
+
+#endif
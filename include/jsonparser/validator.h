@@ -0,0 +1,16 @@
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include <string>
+#include "jsonparser/error.h"
+
+namespace json_parser{
+
+typedef ParseResult ValidateResult;     //offset为出错位置的字节偏移
+
+//按RFC 8259检查语法与UTF-8编码，不构建Json对象，也不申请堆内存
+ValidateResult Validate(const char *json, unsigned long length);
+ValidateResult Validate(const std::string &json);
+}
+
+#endif
@@ -0,0 +1,480 @@
+#include "json_parser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+using namespace json_parser;
+
+//全局分配计数，替换operator new后动态库内的分配同样会被统计
+static unsigned long long g_alloc_count = 0;
+static unsigned long long g_alloc_bytes = 0;
+static volatile unsigned long g_sink = 0;  //防止被优化掉的比较结果
+
+void *operator new(std::size_t size){
+    ++g_alloc_count;
+    g_alloc_bytes += size;
+    void *p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+namespace{
+
+struct Options{
+    double scale = 1.0;
+    double min_time = 0.3;
+    bool json_output = false;
+    std::string corpus;
+    std::string baseline;
+    double threshold = 10.0;
+};
+
+struct Result{
+    std::string corpus;
+    std::string workload;
+    unsigned long long bytes;
+    unsigned long long iterations;
+    double seconds;
+    double mb_per_s;
+    double docs_per_s;
+    double allocs_per_doc;
+    double alloc_bytes_per_doc;
+    long peak_rss_kb;
+};
+
+long PeakRssKb(){
+#if !defined(_WIN32)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+//固定种子的线性同余生成器，保证每次生成的语料一致
+class Random{
+public:
+    explicit Random(unsigned long long seed) : state_(seed){}
+
+    unsigned long Next(){
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned long)(state_ >> 33);
+    }
+
+    unsigned long Range(unsigned long n){
+        return Next() % n;
+    }
+
+    double Real(double lo, double hi){
+        return lo + (hi - lo) * (Next() % 1000000007UL) / 1000000007.0;
+    }
+
+    std::string Word(unsigned long min_len, unsigned long max_len){
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+        unsigned long len = min_len + Range(max_len - min_len + 1);
+        std::string word;
+        for(unsigned long i = 0; i < len; i++)
+            word += letters[Range(26)];
+        return word;
+    }
+
+    std::string Sentence(unsigned long words){
+        std::string text;
+        for(unsigned long i = 0; i < words; i++){
+            if(i)
+                text += ' ';
+            text += Word(2, 9);
+        }
+        return text;
+    }
+
+private:
+    unsigned long long state_;
+};
+
+std::string Number(double value, int precision){
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.*f", precision, value);
+    return buf;
+}
+
+//类似twitter.json：字符串与嵌套对象混合
+std::string MakeTwitter(double scale){
+    Random rnd(1);
+    int count = (int)(800 * scale) + 1;
+    std::string s = "{\"statuses\":[";
+    for(int i = 0; i < count; i++){
+        if(i)
+            s += ',';
+        s += "{\"id\":" + std::to_string(100000 + i);
+        s += ",\"text\":\"" + rnd.Sentence(8 + rnd.Range(16)) + "\"";
+        s += ",\"user\":{\"id\":" + std::to_string(rnd.Range(1000000));
+        s += ",\"name\":\"" + rnd.Word(4, 12) + "\"";
+        s += ",\"screen_name\":\"" + rnd.Word(4, 12) + "\"";
+        s += ",\"description\":\"" + rnd.Sentence(rnd.Range(12)) + "\"";
+        s += ",\"followers_count\":" + std::to_string(rnd.Range(50000));
+        s += ",\"verified\":false,\"lang\":\"en\"}";
+        s += ",\"entities\":{\"hashtags\":[";
+        unsigned long tags = rnd.Range(4);
+        for(unsigned long t = 0; t < tags; t++){
+            if(t)
+                s += ',';
+            s += "{\"text\":\"" + rnd.Word(3, 10) + "\",\"indices\":[" +
+                 std::to_string(t * 10) + "," + std::to_string(t * 10 + 8) + "]}";
+        }
+        s += "],\"urls\":[],\"user_mentions\":[]}";
+        s += ",\"retweet_count\":" + std::to_string(rnd.Range(500));
+        s += ",\"favorited\":false,\"retweeted\":false,\"coordinates\":null";
+        s += ",\"in_reply_to_status_id\":null,\"lang\":\"en\"}";
+    }
+    s += "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924,"
+         "\"query\":\"benchmark\",\"count\":" + std::to_string(count) + "}}";
+    return s;
+}
+
+//类似canada.json：大量浮点坐标
+std::string MakeCanada(double scale){
+    Random rnd(2);
+    int rings = (int)(480 * scale) + 1;
+    std::string s = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                    "\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\","
+                    "\"coordinates\":[";
+    for(int r = 0; r < rings; r++){
+        if(r)
+            s += ',';
+        s += '[';
+        unsigned long points = 20 + rnd.Range(200);
+        for(unsigned long p = 0; p < points; p++){
+            if(p)
+                s += ',';
+            s += '[' + Number(rnd.Real(-141.0, -52.0), 15) + ',' +
+                 Number(rnd.Real(41.0, 83.0), 15) + ']';
+        }
+        s += ']';
+    }
+    s += "]}}]}";
+    return s;
+}
+
+//类似citm_catalog.json：以对象为主，键多且短
+std::string MakeCitm(double scale){
+    Random rnd(3);
+    int events = (int)(250 * scale) + 1;
+    std::string s = "{\"areaNames\":{";
+    for(int i = 0; i < 60; i++){
+        if(i)
+            s += ',';
+        s += "\"" + std::to_string(205705993 + i) + "\":\"" + rnd.Sentence(2) + "\"";
+    }
+    s += "},\"events\":{";
+    for(int i = 0; i < events; i++){
+        if(i)
+            s += ',';
+        s += "\"" + std::to_string(138586341 + i) + "\":{\"description\":null,\"id\":" +
+             std::to_string(138586341 + i) + ",\"logo\":null,\"name\":\"" + rnd.Sentence(3) +
+             "\",\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,"
+             "\"subtitle\":null,\"topicIds\":[324846099,107888604]}";
+    }
+    s += "},\"performances\":[";
+    for(int i = 0; i < events; i++){
+        if(i)
+            s += ',';
+        s += "{\"eventId\":" + std::to_string(138586341 + i) + ",\"id\":" +
+             std::to_string(339887544 + i) + ",\"logo\":null,\"name\":null,\"prices\":[";
+        unsigned long prices = 1 + rnd.Range(4);
+        for(unsigned long p = 0; p < prices; p++){
+            if(p)
+                s += ',';
+            s += "{\"amount\":" + std::to_string(9000 + 1000 * rnd.Range(80)) +
+                 ",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":" +
+                 std::to_string(338937295 + p) + "}";
+        }
+        s += "],\"seatCategories\":[{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]},"
+             "{\"areaId\":205705998,\"blockIds\":[]}],\"seatCategoryId\":338937295}],"
+             "\"seatMapImage\":null,\"start\":" + std::to_string(1372701600000ULL / 1000 + i) +
+             ",\"venueCode\":\"PLEYEL_PLEYEL\"}";
+    }
+    s += "]}";
+    return s;
+}
+
+//深层嵌套：数组与对象交替
+std::string MakeDeep(double scale){
+    int depth = (int)(500 * scale) + 1;
+    std::string s;
+    for(int i = 0; i < depth; i++)
+        s += (i % 2) ? "{\"k\":" : "[1,";
+    s += "null";
+    for(int i = depth - 1; i >= 0; i--)
+        s += (i % 2) ? "}" : "]";
+    return s;
+}
+
+//长字符串，包含少量转义
+std::string MakeLongStrings(double scale){
+    Random rnd(5);
+    int count = (int)(32 * scale) + 1;
+    std::string s = "[";
+    for(int i = 0; i < count; i++){
+        if(i)
+            s += ',';
+        s += '\"';
+        std::string::size_type start = s.size();
+        while(s.size() - start < 65536){
+            s += rnd.Sentence(16);
+            s += (rnd.Range(4) == 0) ? "\\n " : " ";
+            if(rnd.Range(8) == 0)
+                s += "\\\"quoted\\\" ";
+        }
+        s += '\"';
+    }
+    s += ']';
+    return s;
+}
+
+struct Corpus{
+    const char *name;
+    std::string (*make)(double);
+};
+
+const Corpus kCorpora[] = {
+    {"twitter", MakeTwitter},
+    {"canada", MakeCanada},
+    {"citm_catalog", MakeCitm},
+    {"deep_nesting", MakeDeep},
+    {"long_strings", MakeLongStrings},
+};
+
+//重复执行直到达到最小时间，bytes为每次处理的字节数
+Result Measure(const std::string &corpus, const std::string &workload, unsigned long long bytes,
+               double min_time, const std::function<void()> &body){
+    typedef std::chrono::steady_clock Clock;
+    body();     //预热
+
+    unsigned long long alloc_count = g_alloc_count;
+    unsigned long long alloc_bytes = g_alloc_bytes;
+    unsigned long long iterations = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do{
+        body();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }while(elapsed < min_time);
+
+    Result r;
+    r.corpus = corpus;
+    r.workload = workload;
+    r.bytes = bytes;
+    r.iterations = iterations;
+    r.seconds = elapsed;
+    r.mb_per_s = bytes * iterations / elapsed / (1024.0 * 1024.0);
+    r.docs_per_s = iterations / elapsed;
+    r.allocs_per_doc = (double)(g_alloc_count - alloc_count) / iterations;
+    r.alloc_bytes_per_doc = (double)(g_alloc_bytes - alloc_bytes) / iterations;
+    r.peak_rss_kb = PeakRssKb();
+    return r;
+}
+
+//对顶层容器做一组写时复制修改
+void Mutate(Json &json){
+    if(json.IsArray()){
+        json.Append(1);
+        json.Insert(0, Json("bench"));
+        json[0] = 2;
+        json.Remove(0);
+        json.Remove((int)json.Size() - 1);
+    }else if(json.IsObject()){
+        json.Insert("bench_key", Json(1));
+        json["bench_key"] = 2;
+        json.Remove("bench_key");
+    }
+}
+
+void RunCorpus(const Corpus &corpus, const Options &options, std::vector<Result> &results){
+    std::string text = corpus.make(options.scale);
+    Json doc = ParseJsonString(text);
+    Json other = ParseJsonString(text);    //独立解析，保证Equal不会因共享内存而短路
+    unsigned long long size = text.size();
+    std::string out = doc.ToJsonString();
+
+    results.push_back(Measure(corpus.name, "parse", size, options.min_time, [&](){
+        Json json = ParseJsonString(text);
+    }));
+    Parser parser;
+    Json reused;
+    results.push_back(Measure(corpus.name, "reparse", size, options.min_time, [&](){
+        parser.Reset(text);
+        parser.Parse(reused);    //复用上一次的缓冲区
+    }));
+    Parser packed;
+    packed.set_pack_numeric_arrays(true);
+    results.push_back(Measure(corpus.name, "packed", size, options.min_time, [&](){
+        packed.Reset(text);
+        Json json = packed.Parse();    //只含数字的数组紧凑存储
+    }));
+    results.push_back(Measure(corpus.name, "serialize", out.size(), options.min_time, [&](){
+        out = doc.ToJsonString();
+    }));
+    Json cached = ParseJsonString(text);
+    cached.ToCachedJsonString();
+    results.push_back(Measure(corpus.name, "cached", out.size(), options.min_time, [&](){
+        Json json = cached;
+        Mutate(json);
+        out = json.ToCachedJsonString();    //只有顶层容器被修改，子树复用缓存
+    }));
+    std::string pretty = Prettify(text);
+    results.push_back(Measure(corpus.name, "minify", pretty.size(), options.min_time, [&](){
+        out.clear();
+        Minify(pretty.data(), pretty.size(), out);
+    }));
+    results.push_back(Measure(corpus.name, "prettify", size, options.min_time, [&](){
+        out.clear();
+        Prettify(text.data(), text.size(), out);
+    }));
+    results.push_back(Measure(corpus.name, "copy", size, options.min_time, [&](){
+        Json json;
+        json.Copy(doc);
+    }));
+    results.push_back(Measure(corpus.name, "equal", size, options.min_time, [&](){
+        g_sink = g_sink + doc.Equal(other);
+    }));
+    results.push_back(Measure(corpus.name, "mutate", size, options.min_time, [&](){
+        Json json = doc;
+        Mutate(json);
+    }));
+}
+
+void PrintTable(const std::vector<Result> &results){
+    std::printf("%-14s %-10s %10s %12s %12s %14s %16s %12s\n", "corpus", "workload",
+                "bytes", "MB/s", "docs/s", "allocs/doc", "alloc-bytes/doc", "peak-rss-kb");
+    for(const Result &r : results){
+        std::printf("%-14s %-10s %10llu %12.2f %12.2f %14.1f %16.1f %12ld\n", r.corpus.c_str(),
+                    r.workload.c_str(), r.bytes, r.mb_per_s, r.docs_per_s, r.allocs_per_doc,
+                    r.alloc_bytes_per_doc, r.peak_rss_kb);
+    }
+}
+
+void PrintJson(const std::vector<Result> &results, const Options &options){
+    std::printf("{\"version\":1,\"scale\":%.3f,\"results\":[", options.scale);
+    for(size_t i = 0; i < results.size(); i++){
+        const Result &r = results[i];
+        std::printf("%s\n{\"corpus\":\"%s\",\"workload\":\"%s\",\"bytes\":%llu,\"iterations\":%llu,"
+                    "\"seconds\":%.6f,\"mb_per_s\":%.3f,\"docs_per_s\":%.3f,"
+                    "\"allocs_per_doc\":%.1f,\"alloc_bytes_per_doc\":%.1f,\"peak_rss_kb\":%ld}",
+                    i ? "," : "", r.corpus.c_str(), r.workload.c_str(), r.bytes, r.iterations,
+                    r.seconds, r.mb_per_s, r.docs_per_s, r.allocs_per_doc,
+                    r.alloc_bytes_per_doc, r.peak_rss_kb);
+    }
+    std::printf("\n]}\n");
+}
+
+double ToDouble(Json json){
+    if(json.IsInt())
+        return (int)json;
+    if(json.IsDouble())
+        return (double)json;
+    return 0;
+}
+
+//与基线结果比较，吞吐量下降超过阈值时返回false
+bool CompareBaseline(const std::vector<Result> &results, const Options &options){
+    std::ifstream file(options.baseline.c_str());
+    if(!file.is_open()){
+        std::fprintf(stderr, "failed to open baseline `%s`\n", options.baseline.c_str());
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    Json baseline = ParseJsonString(ss.str());
+    Json entries = baseline["results"];
+
+    bool ok = true;
+    std::fprintf(stderr, "%-14s %-10s %12s %12s %9s\n", "corpus", "workload", "base MB/s",
+                 "MB/s", "change");
+    for(const Result &r : results){
+        for(unsigned long i = 0; i < entries.Size(); i++){
+            Json entry = entries[i];
+            if((std::string)entry["corpus"] != r.corpus ||
+               (std::string)entry["workload"] != r.workload)
+                continue;
+            double base = ToDouble(entry["mb_per_s"]);
+            double change = base > 0 ? (r.mb_per_s - base) / base * 100.0 : 0.0;
+            bool regressed = change < -options.threshold;
+            std::fprintf(stderr, "%-14s %-10s %12.2f %12.2f %8.1f%%%s\n", r.corpus.c_str(),
+                         r.workload.c_str(), base, r.mb_per_s, change,
+                         regressed ? "  REGRESSION" : "");
+            ok = ok && !regressed;
+        }
+    }
+    return ok;
+}
+
+void Usage(const char *name){
+    std::fprintf(stderr,
+                 "usage: %s [--json] [--scale <factor>] [--min-time <seconds>]\n"
+                 "          [--corpus <name>] [--baseline <file> [--threshold <percent>]]\n"
+                 "corpora: twitter canada citm_catalog deep_nesting long_strings\n",
+                 name);
+}
+}
+
+int main(int argc, char **argv){
+    Options options;
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--json"){
+            options.json_output = true;
+        }else if(arg == "--scale" && has_value){
+            options.scale = std::atof(argv[++i]);
+        }else if(arg == "--min-time" && has_value){
+            options.min_time = std::atof(argv[++i]);
+        }else if(arg == "--corpus" && has_value){
+            options.corpus = argv[++i];
+        }else if(arg == "--baseline" && has_value){
+            options.baseline = argv[++i];
+        }else if(arg == "--threshold" && has_value){
+            options.threshold = std::atof(argv[++i]);
+        }else{
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    for(const Corpus &corpus : kCorpora){
+        if(!options.corpus.empty() && options.corpus != corpus.name)
+            continue;
+        RunCorpus(corpus, options, results);
+    }
+    if(results.empty()){
+        Usage(argv[0]);
+        return 2;
+    }
+
+    if(options.json_output)
+        PrintJson(results, options);
+    else
+        PrintTable(results);
+
+    if(!options.baseline.empty() && !CompareBaseline(results, options))
+        return 1;
+    return 0;
+}
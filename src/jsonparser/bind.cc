@@ -0,0 +1,144 @@
+#include "jsonparser/bind.h"
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace json_parser{
+
+void ExpectToken(Scanner &scanner, JsonTokenType expected, const char *message){
+    if(scanner.Scan() != expected)
+        throw std::runtime_error(message);
+}
+
+namespace{
+//token应为Json对象的键，随后读取`:`
+void SkipKey(Scanner &scanner, JsonTokenType token_type){
+    if(token_type != JsonTokenType::VALUE_STRING)
+        throw std::runtime_error("format error: invalid json string, the key must be a string");
+    ExpectToken(scanner, JsonTokenType::NAME_SEPARATOR, "format error: invalid json string, expected `:`");
+}
+}
+
+//跳过一个完整的值，不构建任何对象，但与解析器一样检查`,`、`:`与括号是否配对
+//以显式的栈代替递归，嵌套很深时也不会耗尽调用栈
+void SkipValue(Scanner &scanner){
+    std::string closers;    //尚未闭合的容器对应的右括号
+    JsonTokenType token_type = scanner.Scan();
+    while(true){
+        //此时token_type是一个值的开始
+        switch(token_type){
+        case JsonTokenType::BEGIN_OBJECT:
+            token_type = scanner.Scan();
+            if(token_type == JsonTokenType::END_OBJECT)
+                break;
+            closers.push_back('}');
+            SkipKey(scanner, token_type);
+            token_type = scanner.Scan();
+            continue;
+        case JsonTokenType::BEGIN_ARRAY:
+            token_type = scanner.Scan();
+            if(token_type == JsonTokenType::END_ARRAY)
+                break;
+            closers.push_back(']');
+            continue;
+        case JsonTokenType::VALUE_STRING:
+        case JsonTokenType::VALUE_NUMBER:
+        case JsonTokenType::LITERAL_TRUE:
+        case JsonTokenType::LITERAL_FALSE:
+        case JsonTokenType::LITERAL_NULL:
+            break;
+        case JsonTokenType::END_OF_FILE:
+            throw std::runtime_error("format error: invalid json string, unexpected end");
+        default:
+            throw std::runtime_error("format error: invalid json string");
+        }
+
+        //一个值结束后，读取`,`进入下一个值，或者闭合所在的容器
+        while(true){
+            if(closers.empty())
+                return;
+            token_type = scanner.Scan();
+            if(token_type == JsonTokenType::VALUE_SEPARATOR){
+                token_type = scanner.Scan();
+                if(closers.back() == '}'){
+                    SkipKey(scanner, token_type);
+                    token_type = scanner.Scan();
+                }
+                break;
+            }
+            JsonTokenType close = closers.back() == '}' ? JsonTokenType::END_OBJECT : JsonTokenType::END_ARRAY;
+            if(token_type != close){
+                if(token_type == JsonTokenType::END_OF_FILE)
+                    throw std::runtime_error("format error: invalid json string, unexpected end");
+                throw std::runtime_error("format error: invalid json string, expected `,`");
+            }
+            closers.pop_back();
+        }
+    }
+}
+
+void JsonBinder<int>::Decode(Scanner &scanner, int &value){
+    if(scanner.Scan() != JsonTokenType::VALUE_NUMBER)
+        throw std::logic_error("type error: the type is not int");
+    double number = scanner.get_number_value();
+    if(std::ceil(number) != std::floor(number))
+        throw std::logic_error("type error: the type is not int");
+    if(number < INT_MIN || number > INT_MAX)
+        throw std::logic_error("type error: the number is out of the range of int");
+    value = (int)number;
+}
+
+void JsonBinder<int>::Encode(const int &value, std::string &out){
+    char buf[16];
+    int length = std::snprintf(buf, sizeof(buf), "%d", value);
+    out.append(buf, length);
+}
+
+void JsonBinder<double>::Decode(Scanner &scanner, double &value){
+    if(scanner.Scan() != JsonTokenType::VALUE_NUMBER)
+        throw std::logic_error("type error: the type is not double");
+    value = scanner.get_number_value();
+}
+
+//Json没有NaN与无穷大的表示
+void JsonBinder<double>::Encode(const double &value, std::string &out){
+    if(!std::isfinite(value))
+        throw std::logic_error("type error: the number is not finite");
+    char buf[32];
+    int length = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    out.append(buf, length);
+}
+
+void JsonBinder<bool>::Decode(Scanner &scanner, bool &value){
+    switch(scanner.Scan()){
+    case JsonTokenType::LITERAL_TRUE:
+        value = true;
+        break;
+    case JsonTokenType::LITERAL_FALSE:
+        value = false;
+        break;
+    default:
+        throw std::logic_error("type error: the type is not bool");
+    }
+}
+
+void JsonBinder<bool>::Encode(const bool &value, std::string &out){
+    out += value ? "true" : "false";
+}
+
+//与Json::ToJsonString一致，字符串内容按原样读写
+void JsonBinder<std::string>::Decode(Scanner &scanner, std::string &value){
+    if(scanner.Scan() != JsonTokenType::VALUE_STRING)
+        throw std::logic_error("type error: the type is not string");
+    value = scanner.get_string_value_quick();
+}
+
+void JsonBinder<std::string>::Encode(const std::string &value, std::string &out){
+    out += '\"';
+    out += value;
+    out += '\"';
+}
+
+}
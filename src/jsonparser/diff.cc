@@ -0,0 +1,152 @@
+#include "jsonparser/json.h"
+#include "json_internal.h"
+#include <algorithm>
+
+namespace json_parser{
+namespace{
+//超过此规模的数组差异不再求最长公共子序列，改为按位置逐个比较
+const unsigned long kMaxLcsCells = 1UL << 20;
+
+Json Operation(const char *op, const std::string &path, const Json *value){
+    Json operation(JsonType::JSON_OBJECT);
+    operation["op"] = op;
+    operation["path"] = path;
+    if(value)
+        operation["value"] = *value;    //与目标文档共享内存
+    return operation;
+}
+
+//先比较哈希，哈希相同时再确认内容
+bool SameValue(const Json &a, unsigned long hash_a, const Json &b, unsigned long hash_b){
+    return a == b || (hash_a == hash_b && a.Equal(b));
+}
+}
+
+Json Json::Diff(const Json& target) const{
+    Json patch(JsonType::JSON_ARRAY);
+    DiffInto(target, "", patch);
+    return patch;
+}
+
+void Json::DiffInto(const Json& target, const std::string& path, Json& patch) const{
+    if(*this == target)
+        return;     //共享同一容器或值相等，无需继续比较
+
+    if(type_ != target.type_ || (type_ != JsonType::JSON_ARRAY && type_ != JsonType::JSON_OBJECT)){
+        if(!Equal(target))
+            patch.value_.array_value->MutableElements().push_back(Operation("replace", path, &target));
+        return;
+    }
+
+    if(type_ == JsonType::JSON_ARRAY){
+        DiffArray(target, path, patch);
+        return;
+    }
+
+    //两个Json对象的键都是有序的，归并比较
+    const ObjectBuffer &source = *value_.object_value;
+    const ObjectBuffer &other = *target.value_.object_value;
+    auto it = source.begin();
+    auto jt = other.begin();
+    while(it != source.end() || jt != other.end()){
+        if(jt == other.end() || (it != source.end() && it->first < jt->first)){
+            patch.value_.array_value->MutableElements().push_back(Operation("remove", path + "/" + EscapeToken(it->first), nullptr));
+            ++it;
+        }else if(it == source.end() || jt->first < it->first){
+            patch.value_.array_value->MutableElements().push_back(Operation("add", path + "/" + EscapeToken(jt->first), &jt->second));
+            ++jt;
+        }else{
+            it->second.DiffInto(jt->second, path + "/" + EscapeToken(it->first), patch);
+            ++it;
+            ++jt;
+        }
+    }
+}
+
+void Json::DiffArray(const Json& target, const std::string& path, Json& patch) const{
+    const JsonVector &source = value_.array_value->Elements();
+    const JsonVector &other = target.value_.array_value->Elements();
+    std::vector<unsigned long> source_hash(source.size());
+    std::vector<unsigned long> other_hash(other.size());
+    for(unsigned long i = 0; i < source.size(); i++)
+        source_hash[i] = source[i].Hash();
+    for(unsigned long i = 0; i < other.size(); i++)
+        other_hash[i] = other[i].Hash();
+
+    //去掉相同的前缀与后缀
+    unsigned long begin = 0;
+    unsigned long source_end = source.size();
+    unsigned long other_end = other.size();
+    while(begin < source_end && begin < other_end &&
+          SameValue(source[begin], source_hash[begin], other[begin], other_hash[begin]))
+        ++begin;
+    while(source_end > begin && other_end > begin &&
+          SameValue(source[source_end - 1], source_hash[source_end - 1], other[other_end - 1], other_hash[other_end - 1])){
+        --source_end;
+        --other_end;
+    }
+
+    unsigned long m = source_end - begin;
+    unsigned long n = other_end - begin;
+    //对齐结果：first为source下标，second为other下标，-1表示该侧没有对应元素
+    std::vector<std::pair<long, long>> steps;
+    if(m > 0 && n > 0 && m * n <= kMaxLcsCells){
+        std::vector<unsigned int> lcs((m + 1) * (n + 1), 0);
+        for(unsigned long i = m; i-- > 0;){
+            for(unsigned long j = n; j-- > 0;){
+                unsigned long x = begin + i, y = begin + j;
+                if(SameValue(source[x], source_hash[x], other[y], other_hash[y]))
+                    lcs[i * (n + 1) + j] = lcs[(i + 1) * (n + 1) + j + 1] + 1;
+                else
+                    lcs[i * (n + 1) + j] = std::max(lcs[(i + 1) * (n + 1) + j], lcs[i * (n + 1) + j + 1]);
+            }
+        }
+        unsigned long i = 0, j = 0;
+        while(i < m || j < n){
+            unsigned long x = begin + i, y = begin + j;
+            if(i < m && j < n && SameValue(source[x], source_hash[x], other[y], other_hash[y])){
+                steps.push_back(std::make_pair((long)x, (long)y));
+                ++i;
+                ++j;
+            }else if(j == n || (i < m && lcs[(i + 1) * (n + 1) + j] >= lcs[i * (n + 1) + j + 1])){
+                steps.push_back(std::make_pair((long)x, -1L));
+                ++i;
+            }else{
+                steps.push_back(std::make_pair(-1L, (long)y));
+                ++j;
+            }
+        }
+    }else{
+        for(unsigned long i = 0; i < m; i++)
+            steps.push_back(std::make_pair((long)(begin + i), -1L));
+        for(unsigned long j = 0; j < n; j++)
+            steps.push_back(std::make_pair(-1L, (long)(begin + j)));
+    }
+
+    //两个匹配之间被删除与被插入的元素两两配对递归比较，多余的删除或插入
+    unsigned long position = begin;
+    std::vector<long> removed, added;
+    for(unsigned long k = 0; k <= steps.size(); k++){
+        bool matched = k == steps.size() || (steps[k].first >= 0 && steps[k].second >= 0);
+        if(!matched){
+            if(steps[k].first >= 0)
+                removed.push_back(steps[k].first);
+            else
+                added.push_back(steps[k].second);
+            continue;
+        }
+
+        unsigned long pairs = std::min(removed.size(), added.size());
+        for(unsigned long t = 0; t < pairs; t++, position++)
+            source[removed[t]].DiffInto(other[added[t]], path + "/" + std::to_string(position), patch);
+        for(unsigned long t = pairs; t < removed.size(); t++)
+            patch.value_.array_value->MutableElements().push_back(Operation("remove", path + "/" + std::to_string(position), nullptr));
+        for(unsigned long t = pairs; t < added.size(); t++, position++)
+            patch.value_.array_value->MutableElements().push_back(Operation("add", path + "/" + std::to_string(position), &other[added[t]]));
+        removed.clear();
+        added.clear();
+        position++;     //匹配的元素保持不变
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+#include "jsonparser/error.h"
+
+namespace json_parser{
+
+const char *ErrorMessage(ErrorCode code){
+    switch(code){
+    case ErrorCode::OK:
+        return "ok";
+    case ErrorCode::UNEXPECTED_END:
+        return "format error: invalid json string, unexpected end";
+    case ErrorCode::INVALID_VALUE:
+        return "format error: invalid json string";
+    case ErrorCode::INVALID_TRUE:
+        return "format error: invalid json string, the `true` error";
+    case ErrorCode::INVALID_FALSE:
+        return "format error: invalid json string, the `false` error";
+    case ErrorCode::INVALID_NULL:
+        return "format error: invalid json string, the `null` error";
+    case ErrorCode::INVALID_NUMBER:
+        return "format error: invalid json string, the number error";
+    case ErrorCode::INVALID_STRING:
+        return "format error: invalid json string, control character in string";
+    case ErrorCode::INVALID_ESCAPE:
+        return "format error: invalid json string, invalid escape sequence";
+    case ErrorCode::INVALID_UTF8:
+        return "format error: invalid json string, invalid utf-8 sequence";
+    case ErrorCode::MISSING_QUOTE:
+        return "format error: invalid json string, missing closing quote";
+    case ErrorCode::EXPECTED_KEY:
+        return "format error: invalid json string, the key must be a string";
+    case ErrorCode::EXPECTED_COLON:
+        return "format error: invalid json string, expected `:`";
+    case ErrorCode::EXPECTED_COMMA:
+        return "format error: invalid json string, expected `,`";
+    case ErrorCode::TRAILING_CHARACTERS:
+        return "format error: invalid json string, unexpected characters after the value";
+    case ErrorCode::DEPTH_EXCEEDED:
+        return "format error: invalid json string, nesting too deep";
+    case ErrorCode::OUT_OF_MEMORY:
+        return "memory error: out of memory";
+    default:
+        return "unknow error";
+    }
+}
+
+}
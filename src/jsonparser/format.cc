@@ -0,0 +1,280 @@
+#include "jsonparser/format.h"
+#include "jsonparser/error.h"
+#include "simd_internal.h"
+#include <stdexcept>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace json_parser{
+namespace{
+//Reserve返回至少n个字节的可写空间，写入后以Commit提交实际写入的字节数
+class StringOutput{
+public:
+    explicit StringOutput(std::string &output) : output_(output), size_(output.size()){}
+    ~StringOutput(){
+        output_.resize(size_);
+    }
+
+    char *Reserve(unsigned long size){
+        if(size_ + size > output_.size())
+            output_.resize(std::max(output_.size() * 2, size_ + size));
+        return &output_[size_];
+    }
+    void Commit(unsigned long size){
+        size_ += size;
+    }
+    void Append(const char *data, unsigned long size){
+        std::memcpy(Reserve(size), data, size);
+        size_ += size;
+    }
+    void Put(char c){
+        *Reserve(1) = c;
+        ++size_;
+    }
+
+private:
+    std::string &output_;
+    unsigned long size_;
+};
+
+//先写入固定大小的缓冲区，写满后再调用write
+class FdOutput{
+public:
+    explicit FdOutput(int fd) : fd_(fd), size_(0){}
+
+    char *Reserve(unsigned long size){
+        if(size_ + size > kBufferSize)
+            Flush();
+        return buffer_ + size_;
+    }
+    void Commit(unsigned long size){
+        size_ += size;
+    }
+    void Append(const char *data, unsigned long size){
+        if(size > kBufferSize){
+            Flush();
+            Write(data, size);
+            return;
+        }
+        std::memcpy(Reserve(size), data, size);
+        size_ += size;
+    }
+    void Put(char c){
+        *Reserve(1) = c;
+        ++size_;
+    }
+    void Flush(){
+        Write(buffer_, size_);
+        size_ = 0;
+    }
+
+private:
+    void Write(const char *data, unsigned long size){
+        while(size > 0){
+#ifdef _WIN32
+            int written = ::_write(fd_, data, (unsigned)std::min(size, (unsigned long)INT_MAX));
+#else
+            ssize_t written = ::write(fd_, data, size);
+#endif
+            if(written < 0){
+                if(errno == EINTR)
+                    continue;
+                throw std::runtime_error("io error: write failed");
+            }
+            data += written;
+            size -= written;
+        }
+    }
+
+private:
+    static const unsigned long kBufferSize = 64 * 1024;
+    int fd_;
+    unsigned long size_;
+    char buffer_[kBufferSize];
+};
+
+//pos位于开头的`"`，返回闭合`"`之后的位置
+unsigned long SkipString(const char *json, unsigned long pos, unsigned long length){
+    ++pos;
+    while(true){
+        pos = FindQuoteOrEscape(json, pos, length);
+        if(pos >= length)
+            throw std::runtime_error(ErrorMessage(ErrorCode::MISSING_QUOTE));
+        if(json[pos] == '\"')
+            return pos + 1;
+        pos += 2;   //跳过转义字符
+    }
+}
+
+template <typename Output>
+void MinifyTo(const char *json, unsigned long length, Output &output){
+    unsigned long pos = 0;
+    while(pos < length){
+#ifdef JSON_PARSER_SSE2
+        //每次处理16个字节，直到遇到字符串
+        while(pos + 16 <= length){
+            unsigned whitespace, quote;
+            ClassifyWhitespaceAndQuote(json + pos, whitespace, quote);
+            unsigned end = quote ? CountTrailingZeros(quote) : 16;
+            char *out = output.Reserve(16);
+            if(whitespace == 0 && end == 16){
+                std::memcpy(out, json + pos, 16);
+                output.Commit(16);
+            }else{
+                unsigned size = 0;
+                for(unsigned i = 0; i < end; i++){  //无分支地跳过空白字符
+                    out[size] = json[pos + i];
+                    size += ((whitespace >> i) & 1) ^ 1;
+                }
+                output.Commit(size);
+            }
+            pos += end;
+            if(end < 16)
+                break;
+        }
+        if(pos >= length)
+            break;
+#endif
+        char c = json[pos];
+        if(c == '\"'){
+            unsigned long end = SkipString(json, pos, length);
+            output.Append(json + pos, end - pos);
+            pos = end;
+        }else{
+            if(!IsWhitespace(c))
+                output.Put(c);
+            ++pos;
+        }
+    }
+}
+
+template <typename Output>
+void NewLine(Output &output, unsigned long spaces){
+    static const char kSpaces[] = "                                ";
+    const unsigned long chunk = sizeof(kSpaces) - 1;
+    output.Put('\n');
+    while(spaces > chunk){
+        output.Append(kSpaces, chunk);
+        spaces -= chunk;
+    }
+    output.Append(kSpaces, spaces);
+}
+
+bool IsDelimiter(char c){
+    return IsWhitespace(c) || c == ',' || c == ':' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '\"';
+}
+
+template <typename Output>
+void PrettifyTo(const char *json, unsigned long length, Output &output, unsigned indent){
+    std::string closers;    //尚未闭合的括号对应的右括号，长度即为当前深度
+    unsigned long pos = 0;
+    while(true){
+        while(pos < length && IsWhitespace(json[pos]))
+            ++pos;
+        if(pos >= length)
+            break;
+
+        char c = json[pos];
+        switch(c){
+        case '{':
+        case '[':{
+            output.Put(c);
+            ++pos;
+            while(pos < length && IsWhitespace(json[pos]))
+                ++pos;
+            char close = c == '{' ? '}' : ']';
+            if(pos < length && json[pos] == close){    //空的Json对象或Json数组
+                output.Put(close);
+                ++pos;
+            }else{
+                closers.push_back(close);
+                NewLine(output, closers.size() * indent);
+            }
+            break;
+        }
+        case '}':
+        case ']':
+            if(closers.empty())
+                throw std::runtime_error(ErrorMessage(ErrorCode::TRAILING_CHARACTERS));
+            if(closers.back() != c)     //与解析器一致，括号不配对时报告缺少`,`
+                throw std::runtime_error(ErrorMessage(ErrorCode::EXPECTED_COMMA));
+            closers.pop_back();
+            NewLine(output, closers.size() * indent);
+            output.Put(c);
+            ++pos;
+            break;
+        case ',':
+            output.Put(',');
+            NewLine(output, closers.size() * indent);
+            ++pos;
+            break;
+        case ':':
+            output.Append(": ", 2);
+            ++pos;
+            break;
+        case '\"':{
+            unsigned long end = SkipString(json, pos, length);
+            output.Append(json + pos, end - pos);
+            pos = end;
+            break;
+        }
+        default:{   //数字与字面量
+            unsigned long end = pos;
+            while(end < length && !IsDelimiter(json[end]))
+                ++end;
+            output.Append(json + pos, end - pos);
+            pos = end;
+            break;
+        }
+        }
+    }
+    if(!closers.empty())
+        throw std::runtime_error(ErrorMessage(ErrorCode::UNEXPECTED_END));
+}
+}
+
+std::string Minify(const std::string &json){
+    std::string output;
+    Minify(json.data(), json.size(), output);
+    return output;
+}
+
+void Minify(const char *json, unsigned long length, std::string &output){
+    output.reserve(output.size() + length + 16);
+    StringOutput out(output);
+    MinifyTo(json, length, out);
+}
+
+void Minify(const char *json, unsigned long length, int fd){
+    FdOutput out(fd);
+    MinifyTo(json, length, out);
+    out.Flush();
+}
+
+std::string Prettify(const std::string &json, unsigned indent){
+    std::string output;
+    Prettify(json.data(), json.size(), output, indent);
+    return output;
+}
+
+void Prettify(const char *json, unsigned long length, std::string &output, unsigned indent){
+    output.reserve(output.size() + length + length / 2);
+    StringOutput out(output);
+    PrettifyTo(json, length, out, indent);
+}
+
+void Prettify(const char *json, unsigned long length, int fd, unsigned indent){
+    FdOutput out(fd);
+    PrettifyTo(json, length, out, indent);
+    out.Flush();
+}
+
+}
@@ -0,0 +1,243 @@
+#include "jsonparser/reader.h"
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef JSON_PARSER_ZLIB
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
+#endif
+
+namespace json_parser{
+
+#ifdef JSON_PARSER_ZLIB
+
+namespace{
+//Windows上以二进制方式打开，避免换行符被转换
+int OpenFile(const std::string &path){
+#ifdef _WIN32
+    return ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY);
+#endif
+}
+
+void CloseFile(int fd){
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+long ReadFile(int fd, void *data, unsigned long size){
+#ifdef _WIN32
+    return ::_read(fd, data, (unsigned)size);
+#else
+    return ::read(fd, data, size);
+#endif
+}
+}
+
+//单生产者单消费者的环形缓冲区：解压线程写入head_处的槽位，读者读取tail_处的槽位
+//两端只通过head_与tail_交接槽位，等待超过一段时间后才借助条件变量休眠
+class GzipChunkReader::Pipeline{
+public:
+    Pipeline(int fd, bool owns_fd, unsigned long chunk_size, unsigned long ring_size)
+        : fd_(fd), owns_fd_(owns_fd), slots_(ring_size ? ring_size : 1),
+          head_(0), tail_(0), holding_(false), finished_(false), stop_(false), waiters_(0){
+        for(auto it = slots_.begin(); it != slots_.end(); it++)
+            it->data.resize(chunk_size ? chunk_size : 1);
+        thread_ = std::thread(&Pipeline::Run, this);
+    }
+
+    ~Pipeline(){
+        stop_.store(true);
+        Notify();
+        thread_.join();
+        if(owns_fd_)
+            CloseFile(fd_);
+    }
+
+    unsigned long Read(const char *&data){
+        unsigned long tail = tail_.load();
+        if(holding_){
+            tail_.store(++tail);    //上一块已不再使用，归还给解压线程
+            holding_ = false;
+            Notify();
+        }
+        Wait([&]{ return head_.load() != tail || finished_.load(); });
+        if(head_.load() == tail){
+            if(!error_.empty())
+                throw std::runtime_error(error_);
+            return 0;
+        }
+        const Slot &slot = slots_[tail % slots_.size()];
+        holding_ = true;
+        data = slot.data.data();
+        return slot.size;
+    }
+
+private:
+    struct Slot{
+        std::vector<char> data;
+        unsigned long size;
+    };
+
+    static const int kSpinCount = 64;
+
+    template<typename Predicate>
+    void Wait(Predicate ready){
+        for(int i = 0; i < kSpinCount; i++){
+            if(ready())
+                return;
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        condition_.wait(lock, ready);
+        waiters_.fetch_sub(1);
+    }
+
+    //发布方先修改head_、tail_等状态再检查waiters_，与Wait中的顺序相反，不会丢失唤醒
+    void Notify(){
+        if(waiters_.load() == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+
+    void Finish(const std::string &error){
+        error_ = error;
+        finished_.store(true);
+        Notify();
+    }
+
+    void Run(){
+        z_stream stream = z_stream();
+        if(inflateInit2(&stream, 15 + 32) != Z_OK){     //自动识别gzip与zlib头
+            Finish("io error: cannot initialize zlib");
+            return;
+        }
+        std::string error = Decompress(stream);
+        inflateEnd(&stream);
+        Finish(error);
+    }
+
+    std::string Decompress(z_stream &stream){
+        std::vector<unsigned char> input(1 << 16);
+        bool input_end = false;
+        bool member_end = false;    //最近的gzip成员已完整结束
+        unsigned long head = 0;
+        while(true){
+            Wait([&]{ return head - tail_.load() < slots_.size() || stop_.load(); });
+            if(stop_.load())
+                return std::string();
+
+            Slot &slot = slots_[head % slots_.size()];
+            stream.next_out = reinterpret_cast<unsigned char *>(slot.data.data());
+            stream.avail_out = slot.data.size();
+            while(stream.avail_out > 0){
+                if(stream.avail_in == 0 && !input_end){
+                    long size = ReadFile(fd_, input.data(), input.size());
+                    if(size < 0){
+                        if(errno == EINTR)
+                            continue;
+                        return "io error: read failed";
+                    }
+                    if(size == 0)
+                        input_end = true;
+                    stream.next_in = input.data();
+                    stream.avail_in = size;
+                }
+                if(stream.avail_in == 0)
+                    break;
+
+                member_end = false;
+                int result = inflate(&stream, Z_NO_FLUSH);
+                if(result == Z_STREAM_END){
+                    member_end = true;
+                    inflateReset(&stream);  //多个gzip成员首尾相接时继续解压下一个
+                }else if(result != Z_OK && result != Z_BUF_ERROR){
+                    return "format error: invalid gzip data";
+                }
+            }
+
+            slot.size = slot.data.size() - stream.avail_out;
+            if(slot.size > 0){
+                head_.store(++head);
+                Notify();
+            }
+            if(input_end && stream.avail_in == 0)
+                return member_end ? std::string() : "format error: truncated gzip data";
+        }
+    }
+
+    int fd_;
+    bool owns_fd_;
+    std::vector<Slot> slots_;
+    std::atomic<unsigned long> head_;   //已写入的块数
+    std::atomic<unsigned long> tail_;   //已归还的块数
+    bool holding_;                      //读者正在使用tail_处的槽位
+    std::atomic<bool> finished_;
+    std::atomic<bool> stop_;
+    std::string error_;                 //在finished_之前写入
+    std::atomic<int> waiters_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+};
+
+GzipChunkReader::GzipChunkReader(const std::string &path, unsigned long chunk_size, unsigned long ring_size){
+    int fd = OpenFile(path);
+    if(fd < 0)
+        throw std::runtime_error("io error: cannot open " + path);
+    try{
+        pipeline_.reset(new Pipeline(fd, true, chunk_size, ring_size));
+    }catch(...){
+        CloseFile(fd);
+        throw;
+    }
+}
+
+GzipChunkReader::GzipChunkReader(int fd, unsigned long chunk_size, unsigned long ring_size)
+    : pipeline_(new Pipeline(fd, false, chunk_size, ring_size)){
+
+}
+
+unsigned long GzipChunkReader::Read(const char *&data){
+    return pipeline_->Read(data);
+}
+
+#else
+
+//未链接zlib时只保留接口
+class GzipChunkReader::Pipeline{
+};
+
+GzipChunkReader::GzipChunkReader(const std::string &, unsigned long, unsigned long){
+    throw std::runtime_error("io error: gzip support is not enabled");
+}
+
+GzipChunkReader::GzipChunkReader(int, unsigned long, unsigned long){
+    throw std::runtime_error("io error: gzip support is not enabled");
+}
+
+unsigned long GzipChunkReader::Read(const char *&){
+    return 0;
+}
+
+#endif
+
+GzipChunkReader::~GzipChunkReader(){
+
+}
+}
@@ -1,7 +1,14 @@
 #include "jsonparser/json.h"
+#include "json_internal.h"
 #include <stdexcept>
-#include <sstream>
 #include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
 
 namespace json_parser{
 Json::Json()
@@ -26,15 +33,20 @@ Json::Json(bool value)
 
 Json::Json(const char* value)
     :type_(JsonType::JSON_STRING){
-    value_.string_value = std::make_shared<std::string>(value);
+    value_.string_value = MakeBuffer<StringBuffer>(GetDefaultMemoryResource(), value);
 }
 
 Json::Json(const std::string& value)
     :type_(JsonType::JSON_STRING){
-    value_.string_value = std::make_shared<std::string>(value);
+    value_.string_value = MakeBuffer<StringBuffer>(GetDefaultMemoryResource(), value);
 }
 
 Json::Json(JsonType type)
+    :Json(type, GetDefaultMemoryResource()){
+
+}
+
+Json::Json(JsonType type, MemoryResource *resource)
     :type_(type){
     switch(type_){
     case JsonType::JSON_NULL:
@@ -49,38 +61,38 @@ Json::Json(JsonType type)
         value_.bool_value = false;
         break;
     case JsonType::JSON_STRING:
-        value_.string_value = std::make_shared<std::string>("");
+        value_.string_value = MakeBuffer<StringBuffer>(resource, "");
         break;
     case JsonType::JSON_ARRAY:
-        value_.array_value = std::make_shared<std::vector<Json>>();
+        value_.array_value = MakeBuffer<ArrayBuffer>(resource);
         break;
     case JsonType::JSON_OBJECT:
-        value_.object_value = std::make_shared<std::map<std::string, Json>>();
+        value_.object_value = MakeBuffer<ObjectBuffer>(resource);
         break;
     default:
         break;
     }
 }
 
-Json::operator bool(){
+Json::operator bool() const{
     if(this->type_ != JsonType::JSON_BOOL)
         throw std::logic_error("type error: the type is not bool");
     return value_.bool_value;
 }
 
-Json::operator int(){
+Json::operator int() const{
     if(this->type_ != JsonType::JSON_INT)
         throw std::logic_error("type error: the type is not int");
     return value_.int_value;
 }
 
-Json::operator double(){
+Json::operator double() const{
     if(this->type_ != JsonType::JSON_DOUBLE)
         throw std::logic_error("type error: the type is not double");
     return value_.double_value;
 }
 
-Json::operator std::string(){
+Json::operator std::string() const{
     if(this->type_ != JsonType::JSON_STRING)
         throw std::logic_error("type error: the type is not string");
     return *value_.string_value;
@@ -115,8 +127,18 @@ void Json::Clone(const Json& other){
     }
 }
 
-//直接深拷贝，无论是否发生写操作
+//直接深拷贝，无论是否发生写操作，新的缓冲区与other位于同一个内存资源
 void Json::Copy(const Json& other){
+    CopyContainer(other, other.GetMemoryResource());
+}
+
+//内存资源的生命周期各自独立，拷贝到resource时逐层复制，结果不引用other所在资源中的任何缓冲区
+void Json::Copy(const Json& other, MemoryResource *resource){
+    DeepCopy(other, resource);
+}
+
+//只复制最外层的容器，其中的元素仍与other共享
+void Json::CopyContainer(const Json& other, MemoryResource *resource){
     this->type_ = other.type_;
     switch (type_)
     {
@@ -132,13 +154,13 @@ void Json::Copy(const Json& other){
         value_.double_value = other.value_.double_value;
         break;
     case JsonType::JSON_STRING:
-        value_.string_value = std::make_shared<std::string>(*other.value_.string_value);
+        value_.string_value = MakeBuffer<StringBuffer>(resource, *other.value_.string_value);
         break;
     case JsonType::JSON_ARRAY:
-        value_.array_value = std::make_shared<std::vector<Json>>(*other.value_.array_value);
+        value_.array_value = MakeBuffer<ArrayBuffer>(resource, *other.value_.array_value);
         break;
     case JsonType::JSON_OBJECT:
-        value_.object_value = std::make_shared<std::map<std::string, Json>>(*other.value_.object_value);
+        value_.object_value = MakeBuffer<ObjectBuffer>(resource, *other.value_.object_value);
         break;
     default:
         break;
@@ -154,6 +176,21 @@ void Json::operator=(const Json& other){
     this->Clone(other);
 }
 
+//非const访问前调用：容器与其他对象共享时先复制一份，否则只使缓存失效
+void Json::Detach(){
+    if(type_ == JsonType::JSON_ARRAY){
+        if(value_.array_value.use_count() > 1)
+            value_.array_value = CopyShared(*value_.array_value);
+        else
+            value_.array_value->Invalidate();
+    }else if(type_ == JsonType::JSON_OBJECT){
+        if(value_.object_value.use_count() > 1)
+            value_.object_value = CopyShared(*value_.object_value);
+        else
+            value_.object_value->Invalidate();
+    }
+}
+
 Json& Json::operator[](int index){
     if(type_ != JsonType::JSON_ARRAY){
         throw std::logic_error("type error: the type is not json array");
@@ -167,7 +204,8 @@ Json& Json::operator[](int index){
         throw std::logic_error("range error: the index out of range");
     }
 
-    return (*value_.array_value)[index];
+    Detach();   //返回的引用可能被修改
+    return value_.array_value->MutableElements()[index];
 }
 
 Json& Json::operator[](const std::string& key){
@@ -175,6 +213,7 @@ Json& Json::operator[](const std::string& key){
         throw std::logic_error("type error: the type is not json object");
     }
 
+    Detach();
     return (*value_.object_value)[key];
 }
 
@@ -183,71 +222,151 @@ Json& Json::operator[](const char* key){
         throw std::logic_error("type error: the type is not json object");
     }
 
+    Detach();
     return (*value_.object_value)[key];
 }
 
+const Json& Json::operator[](int index) const{
+    if(type_ != JsonType::JSON_ARRAY){
+        throw std::logic_error("type error: the type is not json array");
+    }
+    if(index < 0){
+        throw std::logic_error("range error: the index cannot less than 0");
+    }
+
+    int size = value_.array_value->size();
+    if(index >= size){
+        throw std::logic_error("range error: the index out of range");
+    }
+
+    return value_.array_value->Elements()[index];
+}
+
+const Json& Json::operator[](const std::string& key) const{
+    if(type_ != JsonType::JSON_OBJECT){
+        throw std::logic_error("type error: the type is not json object");
+    }
+
+    auto it = value_.object_value->find(key);
+    if(it == value_.object_value->end()){
+        throw std::logic_error("range error: the key does not exist");
+    }
+    return it->second;
+}
+
+const Json& Json::operator[](const char* key) const{
+    return (*this)[std::string(key)];
+}
+
 void Json::Append(const Json& other){
     if(type_ != JsonType::JSON_ARRAY){
         throw std::logic_error("type error: the type is not json array");
     }
     Json json;
-    json.Copy(other);
-    value_.array_value = std::make_shared<std::vector<Json>>(*value_.array_value);
-    value_.array_value->emplace_back(json);
+    json.Copy(other, value_.array_value->resource());  //元素逐层拷贝到数组所在的内存资源
+    value_.array_value = CopyShared(*value_.array_value);
+    value_.array_value->MutableElements().emplace_back(json);
 }
 
-std::string Json::ToJsonString(){
-    std::stringstream ss;
-    switch (type_)
-    {
+std::string Json::ToJsonString() const{
+    std::string output;
+    AppendJsonString(output, false);
+    return output;
+}
+
+std::string Json::ToCachedJsonString() const{
+    std::string output;
+    AppendJsonString(output, true);
+    return output;
+}
+
+namespace{
+const unsigned long kMinCachedTextSize = 64;    //更短的容器重新输出的代价很低，不缓存以节省内存
+}
+
+//cached为true时复用并填充容器的文本缓存
+void Json::AppendJsonString(std::string &output, bool cached) const{
+    char number[32];
+    switch(type_){
     case JsonType::JSON_NULL:
-        ss << "null";
+        output += "null";
         break;
     case JsonType::JSON_BOOL:
-        ss << (value_.bool_value ? "true" : "false");
+        output += value_.bool_value ? "true" : "false";
         break;
     case JsonType::JSON_INT:
-        ss << value_.int_value;
+        output += std::to_string(value_.int_value);
         break;
     case JsonType::JSON_DOUBLE:
-        ss << value_.double_value;
+        output.append(number, std::snprintf(number, sizeof(number), "%g", value_.double_value));  //与流的默认格式一致
         break;
     case JsonType::JSON_STRING:
-        ss << '\"' << *(value_.string_value) << '\"';
+        output += '\"';
+        output += *value_.string_value;
+        output += '\"';
         break;
     case JsonType::JSON_ARRAY:
-        ss << '[';
-        for (auto it = value_.array_value->begin();
-            it != value_.array_value->end();
-            it++)
         {
-            if (it != value_.array_value->begin())
-            {
-                ss << ',';
+            const ArrayBuffer &array = *value_.array_value;
+            const std::string *text = cached ? array.text.Get() : nullptr;
+            if(text){
+                output += *text;
+                break;
+            }
+            unsigned long start = output.size();
+            output += '[';
+            if(array.packed_type() == JsonType::JSON_INT){
+                //紧凑数组直接输出数值，不展开
+                for(unsigned long i = 0; i < array.size(); i++){
+                    if(i != 0)
+                        output += ',';
+                    output += std::to_string(array.ints()[i]);
+                }
+            }else if(array.packed_type() == JsonType::JSON_DOUBLE){
+                for(unsigned long i = 0; i < array.size(); i++){
+                    if(i != 0)
+                        output += ',';
+                    NumberToJson(array.doubles()[i]).AppendJsonString(output, false);
+                }
+            }else{
+                const JsonVector &elements = array.Elements();
+                for(auto it = elements.begin(); it != elements.end(); it++){
+                    if(it != elements.begin())
+                        output += ',';
+                    it->AppendJsonString(output, cached);
+                }
             }
-            ss << it->ToJsonString();
+            output += ']';
+            if(cached && output.size() - start >= kMinCachedTextSize)
+                array.text.Fill(output, start);
         }
-        ss << ']';
         break;
     case JsonType::JSON_OBJECT:
-        ss << '{';
-        for (auto it = value_.object_value->begin();
-            it != value_.object_value->end();
-            it++)
         {
-            if (it != value_.object_value->begin())
-            {
-                ss << ',';
+            const ObjectBuffer &object = *value_.object_value;
+            const std::string *text = cached ? object.text.Get() : nullptr;
+            if(text){
+                output += *text;
+                break;
+            }
+            unsigned long start = output.size();
+            output += '{';
+            for(auto it = object.begin(); it != object.end(); it++){
+                if(it != object.begin())
+                    output += ',';
+                output += '\"';
+                output += it->first;
+                output += "\":";
+                it->second.AppendJsonString(output, cached);
             }
-            ss << '\"' << it->first << '\"' << ":" << it->second.ToJsonString();
+            output += '}';
+            if(cached && output.size() - start >= kMinCachedTextSize)
+                object.text.Fill(output, start);
         }
-        ss << '}';
         break;
     default:
         break;
     }
-
-    return ss.str();
 }
 
 bool Json::operator==(const Json& other)const{
@@ -278,6 +397,16 @@ bool Json::operator!=(const Json& other)const{
     return !(*this == other);
 }
 
+namespace{
+//两侧的结构哈希都已缓存且不同时内容一定不相等，Json::ArrayBuffer等私有类型只能经由模板参数传入
+template<typename T>
+bool CachedHashDiffers(const T &buffer, const T &other){
+    unsigned long hash = 0;
+    unsigned long other_hash = 0;
+    return buffer.hash.Get(hash) && other.hash.Get(other_hash) && hash != other_hash;
+}
+}
+
 bool Json::Equal(const Json& other)const{
     if (type_ != other.type_)
         return false;
@@ -293,12 +422,36 @@ bool Json::Equal(const Json& other)const{
     case JsonType::JSON_DOUBLE:
         return value_.double_value == other.value_.double_value;
     case JsonType::JSON_STRING:
-        return *(value_.string_value) == *(other.value_.string_value);
+        return value_.string_value == other.value_.string_value ||
+               *(value_.string_value) == *(other.value_.string_value);
     case JsonType::JSON_ARRAY:
-        return *(value_.array_value) == *(other.value_.array_value);
+        {
+            if (value_.array_value == other.value_.array_value)
+                return true;    //共享同一容器
+            if (value_.array_value->size() != other.value_.array_value->size() ||
+                CachedHashDiffers(*value_.array_value, *other.value_.array_value))
+                return false;
+            if (value_.array_value->packed_type() == JsonType::JSON_INT &&
+                other.value_.array_value->packed_type() == JsonType::JSON_INT)
+                return value_.array_value->ints() == other.value_.array_value->ints();
+            if (value_.array_value->packed_type() == JsonType::JSON_DOUBLE &&
+                other.value_.array_value->packed_type() == JsonType::JSON_DOUBLE)
+                return value_.array_value->doubles() == other.value_.array_value->doubles();
+            const JsonVector &elements = value_.array_value->Elements();
+            const JsonVector &other_elements = other.value_.array_value->Elements();
+            for (unsigned long i = 0; i < elements.size(); i++)
+            {
+                if (!elements[i].Equal(other_elements[i]))
+                    return false;
+            }
+            return true;
+        }
     case JsonType::JSON_OBJECT:
         {
-            if (value_.object_value->size() != other.value_.object_value->size())
+            if (value_.object_value == other.value_.object_value)
+                return true;
+            if (value_.object_value->size() != other.value_.object_value->size() ||
+                CachedHashDiffers(*value_.object_value, *other.value_.object_value))
                 return false;
             auto iter1 = value_.object_value->begin();
             auto iter2 = other.value_.object_value->begin();
@@ -306,7 +459,7 @@ bool Json::Equal(const Json& other)const{
             {
                 if (iter1->first != iter2->first)
                     return false;
-                if (!(iter2->second.Equal(iter2->second)))
+                if (!(iter1->second.Equal(iter2->second)))
                     return false;
             }
             return true;
@@ -316,6 +469,175 @@ bool Json::Equal(const Json& other)const{
     }
 }
 
+//递归深拷贝，不与other共享任何容器
+void Json::DeepCopy(const Json& other, MemoryResource *resource){
+    CopyContainer(other, resource);
+    switch(type_){
+    case JsonType::JSON_ARRAY:
+        if(value_.array_value->packed())
+            break;  //紧凑数组只有数值
+        {
+            JsonVector &elements = value_.array_value->MutableElements();
+            for(auto it = elements.begin(); it != elements.end(); it++){
+                Json element = *it;
+                it->DeepCopy(element, resource);
+            }
+        }
+        break;
+    case JsonType::JSON_OBJECT:
+        for(auto it = value_.object_value->begin(); it != value_.object_value->end(); it++){
+            Json element = it->second;
+            it->second.DeepCopy(element, resource);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+//快照内的容器不被其他对象引用，且只能通过const接口访问，因此可以被多个线程同时读取
+std::shared_ptr<const Json> Json::Freeze() const{
+    std::shared_ptr<Json> snapshot = std::make_shared<Json>();
+    snapshot->DeepCopy(*this, GetDefaultMemoryResource());  //快照可能比请求的内存池存活得更久
+    snapshot->Hash();   //预先填充哈希缓存，读者不会再写入
+    return snapshot;
+}
+
+namespace{
+unsigned long CombineHash(unsigned long seed, unsigned long value){
+    return seed ^ (value + 0x9e3779b9UL + (seed << 6) + (seed >> 2));
+}
+}
+
+unsigned long Json::Hash() const{
+    unsigned long seed = static_cast<unsigned long>(type_);
+    switch(type_){
+    case JsonType::JSON_NULL:
+        return seed;
+    case JsonType::JSON_BOOL:
+        return CombineHash(seed, value_.bool_value);
+    case JsonType::JSON_INT:
+        return CombineHash(seed, std::hash<int>()(value_.int_value));
+    case JsonType::JSON_DOUBLE:
+        return CombineHash(seed, std::hash<double>()(value_.double_value));
+    case JsonType::JSON_STRING:
+        return CombineHash(seed, std::hash<std::string>()(*value_.string_value));
+    case JsonType::JSON_ARRAY:
+        {
+            const ArrayBuffer &array = *value_.array_value;
+            unsigned long cached = 0;
+            if(array.hash.Get(cached))
+                return cached;
+            if(array.packed_type() == JsonType::JSON_INT){
+                for(auto it = array.ints().begin(); it != array.ints().end(); it++)
+                    seed = CombineHash(seed, Json(*it).Hash());
+            }else if(array.packed_type() == JsonType::JSON_DOUBLE){
+                for(auto it = array.doubles().begin(); it != array.doubles().end(); it++)
+                    seed = CombineHash(seed, NumberToJson(*it).Hash());
+            }else{
+                for(auto it = array.Elements().begin(); it != array.Elements().end(); it++)
+                    seed = CombineHash(seed, it->Hash());
+            }
+            array.hash.Fill(seed);
+            return seed;
+        }
+    case JsonType::JSON_OBJECT:
+        {
+            const ObjectBuffer &object = *value_.object_value;
+            unsigned long cached = 0;
+            if(object.hash.Get(cached))
+                return cached;
+            for(auto it = object.begin(); it != object.end(); it++){
+                seed = CombineHash(seed, std::hash<std::string>()(it->first));
+                seed = CombineHash(seed, it->second.Hash());
+            }
+            object.hash.Fill(seed);
+            return seed;
+        }
+    default:
+        return seed;
+    }
+}
+
+//后序遍历，子树先去重，再以哈希查找结构相同的已有子树并共享其内存
+void Json::Deduplicate(){
+    std::unordered_map<unsigned long, std::vector<Json>> canonical;
+    std::unordered_map<const void*, Json> visited;  //已处理的容器及其去重后的结果
+
+    std::function<void(Json&)> visit = [&](Json &json){
+        const void *buffer = nullptr;
+        switch(json.type_){
+        case JsonType::JSON_STRING:
+            buffer = json.value_.string_value.get();
+            break;
+        case JsonType::JSON_ARRAY:
+            buffer = json.value_.array_value.get();
+            break;
+        case JsonType::JSON_OBJECT:
+            buffer = json.value_.object_value.get();
+            break;
+        default:
+            return;     //其他类型不占用堆内存
+        }
+
+        auto found = visited.find(buffer);
+        if(found != visited.end()){
+            json.Clone(found->second);
+            return;
+        }
+
+        //只被自身持有的容器原地改写；被共享的容器（例如与快照共享）在子树去重后的结果与原值不同时才复制再写入
+        if(json.type_ == JsonType::JSON_ARRAY && !json.value_.array_value->packed()){
+            if(json.value_.array_value.use_count() == 1){
+                JsonVector &elements = json.value_.array_value->MutableElements();
+                for(auto it = elements.begin(); it != elements.end(); it++)
+                    visit(*it);
+            }else{
+                for(unsigned long i = 0; i < json.value_.array_value->size(); i++){
+                    Json child = json.value_.array_value->Elements()[i];
+                    visit(child);
+                    if(child == json.value_.array_value->Elements()[i])
+                        continue;
+                    if(json.value_.array_value.use_count() > 1)
+                        json.value_.array_value = CopyShared(*json.value_.array_value);
+                    json.value_.array_value->MutableElements()[i] = child;
+                }
+            }
+        }else if(json.type_ == JsonType::JSON_OBJECT){
+            if(json.value_.object_value.use_count() == 1){
+                for(auto it = json.value_.object_value->begin(); it != json.value_.object_value->end(); it++)
+                    visit(it->second);
+            }else{
+                //复制后继续遍历原容器，它仍被其他对象持有
+                const ObjectBuffer *object = json.value_.object_value.get();
+                for(auto it = object->begin(); it != object->end(); it++){
+                    Json child = it->second;
+                    visit(child);
+                    if(child == it->second)
+                        continue;
+                    if(json.value_.object_value.use_count() > 1)
+                        json.value_.object_value = CopyShared(*json.value_.object_value);
+                    json.value_.object_value->find(it->first)->second = child;
+                }
+            }
+        }
+
+        //替换为内容相同的容器，所在容器的哈希缓存仍然有效
+        std::vector<Json> &candidates = canonical[json.Hash()];
+        bool replaced = false;
+        for(auto it = candidates.begin(); it != candidates.end() && !replaced; it++){
+            if(it->Equal(json)){
+                json.Clone(*it);
+                replaced = true;
+            }
+        }
+        if(!replaced)
+            candidates.push_back(json);
+        visited[buffer] = json;
+    };
+    visit(*this);
+}
+
 //制造一份自己的拷贝，深拷贝
 Json Json::CopySelf() const{
     Json json;
@@ -323,6 +645,68 @@ Json Json::CopySelf() const{
     return json;
 }
 
+MemoryResource *Json::GetMemoryResource() const{
+    switch(type_){
+    case JsonType::JSON_STRING:
+        return value_.string_value->resource();
+    case JsonType::JSON_ARRAY:
+        return value_.array_value->resource();
+    case JsonType::JSON_OBJECT:
+        return value_.object_value->resource();
+    default:
+        return GetDefaultMemoryResource();
+    }
+}
+
+JsonType Json::GetPackedType() const{
+    if(type_ != JsonType::JSON_ARRAY)
+        return JsonType::JSON_NULL;
+    return value_.array_value->packed_type();
+}
+
+NumberSpan<int> Json::GetIntSpan() const{
+    if(type_ != JsonType::JSON_ARRAY || value_.array_value->packed_type() != JsonType::JSON_INT){
+        throw std::logic_error("type error: the type is not packed int array");
+    }
+    const IntVector &ints = value_.array_value->ints();
+    return NumberSpan<int>(ints.data(), ints.size());
+}
+
+NumberSpan<double> Json::GetDoubleSpan() const{
+    if(type_ != JsonType::JSON_ARRAY || value_.array_value->packed_type() != JsonType::JSON_DOUBLE){
+        throw std::logic_error("type error: the type is not packed double array");
+    }
+    const DoubleVector &doubles = value_.array_value->doubles();
+    return NumberSpan<double>(doubles.data(), doubles.size());
+}
+
+namespace{
+//展开很少发生，所有数组共用一组互斥量
+std::mutex &ExpandMutex(const void *buffer){
+    static std::mutex mutexes[16];
+    return mutexes[(reinterpret_cast<std::uintptr_t>(buffer) >> 6) % 16];
+}
+}
+
+void Json::ArrayBuffer::Expand() const{
+    std::lock_guard<std::mutex> lock(ExpandMutex(this));
+    if(expanded_.load(std::memory_order_relaxed))
+        return;
+    //展开只写入基类部分，其他线程在expanded_置位之前不会读取它
+    JsonVector &elements = const_cast<ArrayBuffer &>(*this);
+    elements.clear();
+    if(packed_ == JsonType::JSON_INT){
+        elements.reserve(ints_.size());
+        for(auto it = ints_.begin(); it != ints_.end(); it++)
+            elements.emplace_back(*it);
+    }else{
+        elements.reserve(doubles_.size());
+        for(auto it = doubles_.begin(); it != doubles_.end(); it++)
+            elements.push_back(NumberToJson(*it));
+    }
+    expanded_.store(true, std::memory_order_release);
+}
+
 bool Json::IsNull() const{
     return type_ == JsonType::JSON_NULL;
 }
@@ -389,8 +773,9 @@ void Json::Remove(int index){
     if(index >= value_.array_value->size()){
         throw std::logic_error("range error: the index out of the size");
     }
-    value_.array_value = std::make_shared<std::vector<Json> >(*value_.array_value);
-    value_.array_value->erase(value_.array_value->begin()+index);
+    value_.array_value = CopyShared(*value_.array_value);
+    JsonVector &elements = value_.array_value->MutableElements();
+    elements.erase(elements.begin()+index);
 }
 
 void Json::Insert(int index, const Json& json){
@@ -406,8 +791,11 @@ void Json::Insert(int index, const Json& json){
         throw std::logic_error("range error: the index cannot more than the array size");
     }
 
-    value_.array_value = std::make_shared<std::vector<Json>>(*value_.array_value);
-    value_.array_value->insert(value_.array_value->begin()+index,json.CopySelf());
+    Json element;
+    element.Copy(json, value_.array_value->resource());
+    value_.array_value = CopyShared(*value_.array_value);
+    JsonVector &elements = value_.array_value->MutableElements();
+    elements.insert(elements.begin()+index,element);
 }
 
 void Json::Insert(const std::string& key, const Json& json){
@@ -415,8 +803,10 @@ void Json::Insert(const std::string& key, const Json& json){
         throw std::logic_error("type error: the type is not json object");
     }
 
-    value_.object_value = std::make_shared<std::map<std::string,Json>>(*value_.object_value);
-    (*value_.object_value)[key] = json.CopySelf();
+    Json element;
+    element.Copy(json, value_.object_value->resource());
+    value_.object_value = CopyShared(*value_.object_value);
+    (*value_.object_value)[key] = element;
 }
 
 void Json::Insert(const char* key, const Json& json){
@@ -424,8 +814,10 @@ void Json::Insert(const char* key, const Json& json){
         throw std::logic_error("type error: the type is not json object");
     }
 
-    value_.object_value = std::make_shared<std::map<std::string,Json>>(*value_.object_value);
-    (*value_.object_value)[key] = json.CopySelf();
+    Json element;
+    element.Copy(json, value_.object_value->resource());
+    value_.object_value = CopyShared(*value_.object_value);
+    (*value_.object_value)[key] = element;
 }
 
 void Json::Remove(const std::string& key){
@@ -438,7 +830,7 @@ void Json::Remove(const std::string& key){
     }
 
     //否则写时复制
-    value_.object_value = std::make_shared<std::map<std::string,Json>>(*value_.object_value);
+    value_.object_value = CopyShared(*value_.object_value);
     value_.object_value->erase(key);
 }
 
@@ -452,7 +844,7 @@ void Json::Remove(const char* key){
     }
 
     //否则写时复制
-    value_.object_value = std::make_shared<std::map<std::string,Json>>(*value_.object_value);
+    value_.object_value = CopyShared(*value_.object_value);
     value_.object_value->erase(key);
 }
 
@@ -474,12 +866,52 @@ unsigned long Json::Size()const{
     }
 }
 
+Json::iterator Json::begin(){
+    if(type_ != JsonType::JSON_ARRAY){
+        throw std::logic_error("type error: the type is not json array");
+    }
+    Detach();   //返回的元素可能被修改
+    return value_.array_value->MutableElements().data();
+}
+
+Json::iterator Json::end(){
+    return begin() + value_.array_value->size();
+}
+
+Json::const_iterator Json::begin() const{
+    if(type_ != JsonType::JSON_ARRAY){
+        throw std::logic_error("type error: the type is not json array");
+    }
+    return value_.array_value->Elements().data();
+}
+
+Json::const_iterator Json::end() const{
+    return begin() + value_.array_value->size();
+}
+
+Json::ObjectItems Json::Items(){
+    if(type_ != JsonType::JSON_OBJECT){
+        throw std::logic_error("type error: the type is not json object");
+    }
+    Detach();
+    ObjectBuffer &object = *value_.object_value;
+    return ObjectItems(object.begin(), object.end(), object.size());
+}
+
+Json::ConstObjectItems Json::Items() const{
+    if(type_ != JsonType::JSON_OBJECT){
+        throw std::logic_error("type error: the type is not json object");
+    }
+    const ObjectBuffer &object = *value_.object_value;
+    return ConstObjectItems(object.begin(), object.end(), object.size());
+}
+
 bool Json::FindKey(const std::string& key) const{
     if(type_ != JsonType::JSON_OBJECT){
         throw std::logic_error("type error: the type is not json object");
     }
 
-    return value_.object_value->find(key) == value_.object_value->end();
+    return value_.object_value->find(key) != value_.object_value->end();
 }
 
 bool Json::FindKey(const char* key) const{
@@ -487,9 +919,55 @@ bool Json::FindKey(const char* key) const{
         throw std::logic_error("type error: the type is not json object");
     }
 
-    return value_.object_value->find(key) == value_.object_value->end();
+    return value_.object_value->find(key) != value_.object_value->end();
 }
 
+unsigned long Json::MemoryUsage() const{
+    std::set<const void*> visited;
+    std::vector<const Json*> pending(1, this);
+    unsigned long bytes = 0;
+
+    while(!pending.empty()){
+        const Json *json = pending.back();
+        pending.pop_back();
+        switch(json->type_){
+        case JsonType::JSON_STRING:
+            if(visited.insert(json->value_.string_value.get()).second)
+                bytes += sizeof(StringBuffer) + StringHeapSize(*json->value_.string_value);
+            break;
+        case JsonType::JSON_ARRAY:
+            if(visited.insert(json->value_.array_value.get()).second){
+                const ArrayBuffer &array = *json->value_.array_value;
+                bytes += sizeof(array) + array.NumberBytes();
+                const std::string *text = array.text.Get();
+                if(text)
+                    bytes += sizeof(std::string) + StringHeapSize(*text);
+                if(array.packed() && !array.expanded())
+                    break;  //尚未展开的紧凑数组没有元素
+                bytes += array.capacity() * sizeof(Json);
+                for(auto it = array.Elements().begin(); it != array.Elements().end(); it++)
+                    pending.push_back(&*it);
+            }
+            break;
+        case JsonType::JSON_OBJECT:
+            if(visited.insert(json->value_.object_value.get()).second){
+                const ObjectBuffer &object = *json->value_.object_value;
+                bytes += sizeof(object);
+                const std::string *text = object.text.Get();
+                if(text)
+                    bytes += sizeof(std::string) + StringHeapSize(*text);
+                for(auto it = object.begin(); it != object.end(); it++){
+                    bytes += MapNodeSize() + StringHeapSize(it->first);
+                    pending.push_back(&it->second);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return bytes;
+}
 
 Json::~Json() {}
 
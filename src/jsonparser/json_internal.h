@@ -0,0 +1,410 @@
+#ifndef JSON_INTERNAL_H
+#define JSON_INTERNAL_H
+
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "jsonparser/json.h"
+#include "jsonparser/parser.h"
+#include "jsonparser/error.h"
+
+namespace json_parser{
+
+#ifdef JSON_PARSER_SINGLE_THREADED
+typedef unsigned long RefCounter;   //调用者保证Json对象及其副本只在一个线程中使用
+
+inline void IncrementRef(RefCounter &count){
+    ++count;
+}
+inline unsigned long DecrementRef(RefCounter &count){
+    return --count;
+}
+inline unsigned long LoadRef(const RefCounter &count){
+    return count;
+}
+#else
+typedef std::atomic<unsigned long> RefCounter;
+
+inline void IncrementRef(RefCounter &count){
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+inline unsigned long DecrementRef(RefCounter &count){
+    return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+}
+inline unsigned long LoadRef(const RefCounter &count){
+    return count.load(std::memory_order_acquire);
+}
+#endif
+
+//缓冲区的侵入式引用计数，计数归零时析构并归还到缓冲区所在的内存资源
+//拷贝出的缓冲区从1开始计数
+template<typename Derived>
+class RefCounted{
+public:
+    RefCounted() : refs_(1){}
+    RefCounted(const RefCounted &) : refs_(1){}
+    RefCounted &operator=(const RefCounted &){
+        return *this;
+    }
+
+    void Retain() const noexcept{
+        IncrementRef(refs_);
+    }
+    void Release() const noexcept{
+        if(DecrementRef(refs_) == 0){
+            Derived *self = const_cast<Derived *>(static_cast<const Derived *>(this));
+            MemoryResource *resource = self->resource();
+            self->~Derived();
+            resource->Deallocate(self, sizeof(Derived), alignof(Derived));
+        }
+    }
+    unsigned long RefCount() const noexcept{
+        return LoadRef(refs_);
+    }
+
+private:
+    mutable RefCounter refs_;
+};
+
+//字符串缓冲区，记录其所在的内存资源，字符本身仍由std::string管理
+struct Json::StringBuffer : public std::string, public RefCounted<Json::StringBuffer>{
+    StringBuffer(const std::string &value, MemoryResource *resource) : std::string(value), resource_(resource){}
+    StringBuffer(const char *value, MemoryResource *resource) : std::string(value), resource_(resource){}
+
+    MemoryResource *resource() const{
+        return resource_;
+    }
+
+private:
+    MemoryResource *resource_;
+};
+
+//ToCachedJsonString输出的文本缓存。const对象可能在多个线程中同时输出，
+//填充以原子操作进行，同时填充时先完成者生效；Reset只在非const访问时调用
+class TextCache{
+public:
+    TextCache() : text_(nullptr){}
+    TextCache(const TextCache &) = delete;
+    TextCache &operator=(const TextCache &) = delete;
+    ~TextCache(){
+        Reset();
+    }
+
+    const std::string *Get() const{
+        return text_.load(std::memory_order_acquire);
+    }
+
+    void Fill(const std::string &output, unsigned long start){
+        std::string *text = new std::string(output, start);
+        std::string *expected = nullptr;
+        if(!text_.compare_exchange_strong(expected, text, std::memory_order_acq_rel))
+            delete text;
+    }
+
+    void Reset(){
+        delete text_.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<std::string *> text_;
+};
+
+//容器的结构哈希缓存。const对象可能在多个线程中同时计算哈希，结果总是相同，
+//读写以原子操作进行；Reset只在非const访问时调用
+class HashCache{
+public:
+    HashCache() : hash_(0), filled_(false){}
+    HashCache(const HashCache &) = delete;
+    HashCache &operator=(const HashCache &) = delete;
+
+    bool Get(unsigned long &hash) const{
+        if(!filled_.load(std::memory_order_acquire))
+            return false;
+        hash = hash_.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    void Fill(unsigned long hash){
+        hash_.store(hash, std::memory_order_relaxed);
+        filled_.store(true, std::memory_order_release);
+    }
+
+    void Reset(){
+        filled_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<unsigned long> hash_;
+    std::atomic<bool> filled_;
+};
+
+typedef std::vector<int, PolymorphicAllocator<int>> IntVector;
+typedef std::vector<double, PolymorphicAllocator<double>> DoubleVector;
+
+//容器缓冲区，附带结构哈希与序列化文本的缓存。拷贝出的新缓冲区不继承缓存，
+//原地修改（通过非const的[]运算符）时需要调用Invalidate。
+//拷贝时默认沿用原缓冲区的内存资源，以保证写时复制不会改变内存的来源
+//
+//只含数字的数组可以紧凑存储为int或double，此时元素只在第一次被访问时展开，
+//展开后两种表示并存；修改元素前必须通过MutableElements放弃紧凑表示
+struct Json::ArrayBuffer : private JsonVector, public RefCounted<Json::ArrayBuffer>{
+    explicit ArrayBuffer(MemoryResource *resource)
+        : JsonVector(resource), packed_(JsonType::JSON_NULL),
+          ints_(resource), doubles_(resource), expanded_(false){}
+    ArrayBuffer(const ArrayBuffer &other) : ArrayBuffer(other, other.resource()){}
+    ArrayBuffer(const ArrayBuffer &other, MemoryResource *resource)
+        : JsonVector(resource), RefCounted<ArrayBuffer>(), packed_(other.packed_),
+          ints_(other.ints_, resource), doubles_(other.doubles_, resource), expanded_(false){
+        if(!other.packed())
+            JsonVector::assign(other.JsonVector::begin(), other.JsonVector::end());
+    }
+
+    using JsonVector::capacity;
+
+    MemoryResource *resource() const{
+        return get_allocator().resource();
+    }
+
+    unsigned long size() const{
+        switch(packed_){
+        case JsonType::JSON_INT:
+            return ints_.size();
+        case JsonType::JSON_DOUBLE:
+            return doubles_.size();
+        default:
+            return JsonVector::size();
+        }
+    }
+
+    void Invalidate(){
+        hash.Reset();
+        text.Reset();
+    }
+
+    //紧凑存储时为JSON_INT或JSON_DOUBLE，否则为JSON_NULL
+    JsonType packed_type() const{
+        return packed_;
+    }
+
+    bool packed() const{
+        return packed_ != JsonType::JSON_NULL;
+    }
+
+    bool expanded() const{
+        return expanded_.load(std::memory_order_acquire);
+    }
+
+    const IntVector &ints() const{
+        return ints_;
+    }
+
+    const DoubleVector &doubles() const{
+        return doubles_;
+    }
+
+    unsigned long NumberBytes() const{
+        return ints_.capacity() * sizeof(int) + doubles_.capacity() * sizeof(double);
+    }
+
+    //const访问可能发生在多个线程，展开过程是线程安全的
+    const JsonVector &Elements() const{
+        if(packed() && !expanded())
+            Expand();
+        return *this;
+    }
+
+    JsonVector &MutableElements(){
+        if(packed()){
+            Elements();
+            packed_ = JsonType::JSON_NULL;
+            IntVector(resource()).swap(ints_);
+            DoubleVector(resource()).swap(doubles_);
+            expanded_.store(false, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    //以下供解析器使用，此时缓冲区只被解析器持有
+    void BeginNumbers(){
+        JsonVector::clear();
+        packed_ = JsonType::JSON_INT;
+        ints_.clear();
+        doubles_.clear();
+        expanded_.store(false, std::memory_order_relaxed);
+    }
+
+    //整数值都在int范围内时存储为int，出现其他数字后整体转为double
+    void PushNumber(double value){
+        if(packed_ == JsonType::JSON_INT){
+            if(std::ceil(value) == std::floor(value) && value >= INT_MIN && value <= INT_MAX){
+                ints_.push_back((int)value);
+                return;
+            }
+            doubles_.assign(ints_.begin(), ints_.end());
+            IntVector(resource()).swap(ints_);
+            packed_ = JsonType::JSON_DOUBLE;
+        }
+        doubles_.push_back(value);
+    }
+
+    void DropNumbers(){
+        packed_ = JsonType::JSON_NULL;
+        ints_.clear();
+        doubles_.clear();
+        expanded_.store(false, std::memory_order_relaxed);
+    }
+
+    mutable HashCache hash;
+    mutable TextCache text;
+
+private:
+    void Expand() const;
+
+    JsonType packed_;
+    IntVector ints_;
+    DoubleVector doubles_;
+    mutable std::atomic<bool> expanded_;
+};
+
+//与解析器一致，int范围内的整数值为JSON_INT
+inline Json NumberToJson(double value){
+    if(std::ceil(value) == std::floor(value) && value >= INT_MIN && value <= INT_MAX)
+        return Json((int)value);
+    return Json(value);
+}
+
+struct Json::ObjectBuffer : public JsonMap, public RefCounted<Json::ObjectBuffer>{
+    explicit ObjectBuffer(MemoryResource *resource) : JsonMap(resource){}
+    ObjectBuffer(const ObjectBuffer &other)
+        : JsonMap(other, other.get_allocator()), RefCounted<ObjectBuffer>(){}
+    ObjectBuffer(const ObjectBuffer &other, MemoryResource *resource)
+        : JsonMap(other, resource), RefCounted<ObjectBuffer>(){}
+
+    MemoryResource *resource() const{
+        return get_allocator().resource();
+    }
+
+    void Invalidate(){
+        hash.Reset();
+        text.Reset();
+    }
+
+    mutable HashCache hash;
+    mutable TextCache text;
+};
+
+//以下为堆内存占用的估算，与标准库实现相关
+const unsigned long kMapNodeOverhead = 4 * sizeof(void *);                 //红黑树节点的指针与颜色
+
+inline unsigned long StringHeapSize(const std::string &value){
+    static const unsigned long inline_capacity = std::string().capacity();
+    return value.capacity() > inline_capacity ? value.capacity() + 1 : 0;
+}
+
+inline unsigned long MapNodeSize(){
+    return kMapNodeOverhead + sizeof(std::pair<const std::string, Json>);
+}
+
+//将错误码转换为异常，异常的类型与消息与此前直接抛出时一致
+[[noreturn]] inline void ThrowParseError(ErrorCode code){
+    if(code == ErrorCode::OUT_OF_MEMORY)
+        throw std::bad_alloc();
+    throw std::runtime_error(ErrorMessage(code));
+}
+
+//按Json Pointer的规则转义`~`与`/`
+inline std::string EscapeToken(const std::string &token){
+    std::string escaped;
+    for(std::string::size_type i = 0; i < token.size(); i++){
+        if(token[i] == '~')
+            escaped += "~0";
+        else if(token[i] == '/')
+            escaped += "~1";
+        else
+            escaped += token[i];
+    }
+    return escaped;
+}
+
+#ifdef JSON_PARSER_STATS
+extern thread_local ParseStats *current_parse_stats;    //当前线程正在记录的统计对象
+
+inline void RecordAllocation(unsigned long count, unsigned long bytes){
+    if(current_parse_stats){
+        current_parse_stats->allocations += count;
+        current_parse_stats->bytes_allocated += bytes;
+    }
+}
+
+#define JSON_STATS(...) do{ __VA_ARGS__; }while(0)
+#else
+#define JSON_STATS(...) do{}while(0)
+#endif
+
+#ifdef JSON_PARSER_STATS
+//size为缓冲区对象本身的大小
+inline void RecordBuffer(const std::string &value, unsigned long size){
+    unsigned long heap = StringHeapSize(value);
+    RecordAllocation(heap ? 2 : 1, size + heap);
+}
+
+//Json::ArrayBuffer是Json的私有类型，只能以模板参数的形式出现，仅对带有紧凑数值的缓冲区有效
+template<typename T>
+inline auto RecordBuffer(const T &value, unsigned long size) -> decltype(value.NumberBytes(), void()){
+    unsigned long count = 1 + (value.capacity() ? 1 : 0) + (value.ints().capacity() ? 1 : 0) + (value.doubles().capacity() ? 1 : 0);
+    RecordAllocation(count, size + value.capacity() * sizeof(Json) + value.NumberBytes());
+}
+
+inline void RecordBuffer(const JsonMap &value, unsigned long size){
+    unsigned long count = 1 + value.size();
+    unsigned long bytes = size;
+    for(auto it = value.begin(); it != value.end(); it++){
+        unsigned long key_heap = StringHeapSize(it->first);
+        count += key_heap ? 1 : 0;
+        bytes += MapNodeSize() + key_heap;
+    }
+    RecordAllocation(count, bytes);
+}
+#else
+template<typename T>
+inline void RecordBuffer(const T &, unsigned long){}
+#endif
+
+//所有容器都经由此处从resource中申请，以便统计分配
+//T::resource()必须返回resource，计数归零时据此归还内存
+template<typename T, typename... Args>
+RefPtr<T> MakeShared(MemoryResource *resource, Args&&... args){
+    void *memory = resource->Allocate(sizeof(T), alignof(T));
+    T *buffer;
+    try{
+        buffer = new(memory) T(std::forward<Args>(args)...);
+    }catch(...){
+        resource->Deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+    RecordBuffer(*buffer, sizeof(T));
+    return RefPtr<T>(buffer);
+}
+
+//缓冲区本身也记录resource，构造参数的最后一个是内存资源
+template<typename T, typename... Args>
+RefPtr<T> MakeBuffer(MemoryResource *resource, Args&&... args){
+    return MakeShared<T>(resource, std::forward<Args>(args)..., resource);
+}
+
+//写时复制，新缓冲区与原缓冲区使用同一个内存资源
+template<typename T>
+RefPtr<T> CopyShared(const T &buffer){
+    return MakeShared<T>(buffer.resource(), buffer);
+}
+
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "json_parser.h"
+#include "json_internal.h"
 #include <cmath>
 
 namespace json_parser{
@@ -12,14 +13,59 @@ Json ParseJsonString(const char* json_string){
     return parser.Parse();
 }
 
+namespace{
+//每个线程持有一个Parser
+Parser &LocalParser(){
+    static thread_local Parser parser;
+    return parser;
+}
+
+//复用json原有的缓冲区，解析失败时json为null
+template<typename T>
+ParseResult TryParseInto(const T &json_string, Json &json) noexcept{
+    ParseResult result;
+    try{
+        Parser &parser = LocalParser();
+        parser.Reset(json_string);
+        parser.set_memory_resource(nullptr);    //跟随当前的默认内存资源
+        result = parser.TryParse(json);
+    }catch(const std::bad_alloc &){
+        result.error = ErrorCode::OUT_OF_MEMORY;
+        result.offset = 0;
+        json = Json();
+    }
+    return result;
+}
+}
+
 void ParseJsonString(const std::string &json_string,Json& json){
-    Parser parser(json_string);
-    json = parser.Parse();
+    ParseResult result = TryParseInto(json_string, json);
+    if(!result)
+        ThrowParseError(result.error);
 }
 
 void ParseJsonString(const char* json_string,Json& json){
-    Parser parser(json_string);
-    json = parser.Parse();
+    ParseResult result = TryParseInto(json_string, json);
+    if(!result)
+        ThrowParseError(result.error);
+}
+
+ParseResult TryParseJsonString(const std::string &json_string, Json &json) noexcept{
+    return TryParseInto(json_string, json);
+}
+
+ParseResult TryParseJsonString(const char *json_string, Json &json) noexcept{
+    return TryParseInto(json_string, json);
+}
+
+Json ParseJsonString(const std::string& json_string, ParseStats* stats){
+    Parser parser(json_string, stats);
+    return parser.Parse();
+}
+
+Json ParseJsonString(const char* json_string, ParseStats* stats){
+    Parser parser(json_string, stats);
+    return parser.Parse();
 }
 
 }
\ No newline at end of file
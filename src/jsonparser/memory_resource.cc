@@ -0,0 +1,108 @@
+#include "jsonparser/memory_resource.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace json_parser{
+namespace{
+class NewDeleteMemoryResource : public MemoryResource{
+protected:
+    void *DoAllocate(std::size_t bytes, std::size_t){
+        return ::operator new(bytes);
+    }
+    void DoDeallocate(void *p, std::size_t, std::size_t){
+        ::operator delete(p);
+    }
+    bool DoIsEqual(const MemoryResource &other) const noexcept{
+        return this == &other;
+    }
+};
+
+std::atomic<MemoryResource *> &DefaultResource(){
+    static std::atomic<MemoryResource *> resource(NewDeleteResource());
+    return resource;
+}
+}
+
+const std::size_t MemoryResource::kMaxAlign;
+
+MemoryResource::~MemoryResource(){
+
+}
+
+MemoryResource *NewDeleteResource() noexcept{
+    static NewDeleteMemoryResource resource;
+    return &resource;
+}
+
+MemoryResource *GetDefaultMemoryResource() noexcept{
+    return DefaultResource().load(std::memory_order_acquire);
+}
+
+MemoryResource *SetDefaultMemoryResource(MemoryResource *resource) noexcept{
+    if(!resource)
+        resource = NewDeleteResource();
+    return DefaultResource().exchange(resource, std::memory_order_acq_rel);
+}
+
+MonotonicBufferResource::MonotonicBufferResource(std::size_t initial_size, MemoryResource *upstream)
+    : upstream_(upstream), chunks_(nullptr), initial_buffer_(nullptr), initial_size_(0),
+      next_size_(initial_size ? initial_size : 1), current_(nullptr), available_(0){
+
+}
+
+MonotonicBufferResource::MonotonicBufferResource(void *buffer, std::size_t size, MemoryResource *upstream)
+    : upstream_(upstream), chunks_(nullptr), initial_buffer_(buffer), initial_size_(size),
+      next_size_(size ? size : 1), current_(static_cast<char *>(buffer)), available_(size){
+
+}
+
+MonotonicBufferResource::~MonotonicBufferResource(){
+    Release();
+}
+
+void MonotonicBufferResource::Release(){
+    while(chunks_){
+        Chunk *next = chunks_->next;
+        upstream_->Deallocate(chunks_, chunks_->size);
+        chunks_ = next;
+    }
+    current_ = static_cast<char *>(initial_buffer_);
+    available_ = initial_size_;
+}
+
+MemoryResource *MonotonicBufferResource::upstream() const{
+    return upstream_;
+}
+
+void *MonotonicBufferResource::DoAllocate(std::size_t bytes, std::size_t alignment){
+    std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+    if(!current_ || padding + bytes > available_){
+        //当前块不够时向上游申请新块，块的大小按倍数增长
+        std::size_t size = sizeof(Chunk) + bytes + alignment;
+        while(next_size_ < size)
+            next_size_ *= 2;
+        Chunk *chunk = static_cast<Chunk *>(upstream_->Allocate(next_size_));
+        chunk->next = chunks_;
+        chunk->size = next_size_;
+        chunks_ = chunk;
+        current_ = reinterpret_cast<char *>(chunk + 1);
+        available_ = next_size_ - sizeof(Chunk);
+        next_size_ *= 2;
+        padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+    }
+    void *p = current_ + padding;
+    current_ += padding + bytes;
+    available_ -= padding + bytes;
+    return p;
+}
+
+void MonotonicBufferResource::DoDeallocate(void *, std::size_t, std::size_t){
+
+}
+
+bool MonotonicBufferResource::DoIsEqual(const MemoryResource &other) const noexcept{
+    return this == &other;
+}
+
+}
@@ -0,0 +1,59 @@
+#include "jsonparser/ndjson.h"
+#include "json_internal.h"
+#include "simd_internal.h"
+#include <cstring>
+
+namespace json_parser{
+
+NdjsonParser::NdjsonParser() : count_(0){
+
+}
+
+unsigned long NdjsonParser::Run(ChunkReader &reader, const Callback &callback){
+    count_ = 0;
+    line_.clear();
+    const char *data;
+    unsigned long size;
+    while((size = reader.Read(data)) > 0){
+        //一行可能跨越多个块，先拼接到line_
+        const char *end = data + size;
+        while(true){
+            const char *newline = static_cast<const char *>(std::memchr(data, '\n', end - data));
+            if(!newline){
+                line_.append(data, end - data);
+                break;
+            }
+            line_.append(data, newline - data);
+            Emit(callback);
+            data = newline + 1;
+        }
+    }
+    Emit(callback);     //最后一行可以没有换行符
+    return count_;
+}
+
+unsigned long NdjsonParser::Run(const std::string &text, const Callback &callback){
+    MemoryChunkReader reader(text, text.size());
+    return Run(reader, callback);
+}
+
+void NdjsonParser::Emit(const Callback &callback){
+    bool blank = true;
+    for(auto it = line_.begin(); it != line_.end() && blank; it++)
+        blank = IsWhitespace(*it);
+    if(!blank){
+        parser_.Reset(line_);
+        ParseResult result = parser_.TryParse(value_);
+        if(!result)
+            ThrowParseError(result.error);
+        //一行只能有一个值，其后只允许空白（包括CRLF中的\r）
+        for(unsigned long i = result.offset; i < line_.size(); i++){
+            if(!IsWhitespace(line_[i]))
+                ThrowParseError(ErrorCode::TRAILING_CHARACTERS);
+        }
+        ++count_;
+        callback(value_);
+    }
+    line_.clear();
+}
+}
@@ -1,10 +1,79 @@
 #include "jsonparser/parser.h"
+#include "json_internal.h"
+#include "simd_internal.h"
 #include <stdexcept>
 #include <cmath>
+#include <climits>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
 // #include <iostream>
 
 namespace json_parser{
 
+const unsigned long kMaxDepth = 4096;   //与Validate的嵌套深度上限一致
+
+#ifdef JSON_PARSER_STATS
+thread_local ParseStats *current_parse_stats = nullptr;
+
+namespace{
+typedef std::chrono::steady_clock StatsClock;
+
+double SecondsSince(StatsClock::time_point start){
+    return std::chrono::duration<double>(StatsClock::now() - start).count();
+}
+
+void RecordStringCopy(const std::string &value){
+    if(unsigned long heap = StringHeapSize(value))
+        RecordAllocation(1, heap);
+}
+
+//解析期间将统计对象设置为当前线程的统计对象，异常时也能恢复
+class StatsScope{
+public:
+    explicit StatsScope(ParseStats *stats)
+        : previous_(current_parse_stats){
+        current_parse_stats = stats;
+    }
+    ~StatsScope(){
+        current_parse_stats = previous_;
+    }
+
+private:
+    ParseStats *previous_;
+};
+}
+#endif
+
+ParseStats::ParseStats(){
+    Reset();
+}
+
+void ParseStats::Reset(){
+    bytes_consumed = 0;
+    std::memset(token_counts, 0, sizeof(token_counts));
+    max_depth = 0;
+    string_bytes = 0;
+    number_count = 0;
+    allocations = 0;
+    bytes_allocated = 0;
+    scan_seconds = 0;
+    build_seconds = 0;
+    total_seconds = 0;
+}
+
+unsigned long ParseStats::TokenCount(JsonTokenType type) const{
+    return token_counts[static_cast<int>(type)];
+}
+
+bool ParseStats::Enabled(){
+#ifdef JSON_PARSER_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool Scanner::IsEnd(){
     return current_ >= json_string_.end();
 }
@@ -15,76 +84,58 @@ char Scanner::Advance(){
     return c;
 }
 
-void Scanner::ScanTrue(){
+bool Scanner::ScanTrue(){
     if(json_string_.compare(
             std::distance(json_string_.begin(),current_),   //获取当前索引
             3,
             "rue"
         )==0){
         current_ += 3;
-    }else{
-        throw std::runtime_error("format error: invalid json string, the `true` error");
+        return true;
     }
+    return false;
 }
 
-void Scanner::ScanFalse(){
+bool Scanner::ScanFalse(){
     if (json_string_.compare(
             std::distance(json_string_.begin(), current_), // 获取当前索引
             4,
             "alse") == 0){
         current_ += 4;
+        return true;
     }
-    else{
-        throw std::runtime_error("format error: invalid json string, the `false` error");
-    }
+    return false;
 }
 
-void Scanner::ScanNull(){
+bool Scanner::ScanNull(){
     if (json_string_.compare(
             std::distance(json_string_.begin(), current_), // 获取当前索引
             3,
             "ull") == 0){
         current_ += 3;
+        return true;
     }
-    else{
-        throw std::runtime_error("format error: invalid json string, the `null` error");
-    }
+    return false;
 }
 
-void Scanner::ScanString(){
-    std::string::iterator temp = current_;
-
-    while(Peek()!= '\"' && !IsEnd()){
-        Advance();
-        if(Peek()!='\\')
-            continue;
-        Advance();
-        switch(Peek()){
-        case 'b':
-        case 't':
-        case 'n':
-        case 'f':
-        case 'r':
-        case '\"':
-        case '\\':
-            Advance();
-            break;
-        case 'u':
-            for (int i = 0; i < 4; i++){    //Unicode长度4字节
-                Advance();
-            }
-            break;
-        default:
+//按16字节一组查找`"`与`\`，转义字符之后的一个字节总是被跳过
+bool Scanner::ScanString(){
+    const char *data = json_string_.data();
+    unsigned long length = json_string_.size();
+    unsigned long begin = current_ - json_string_.begin();
+    unsigned long pos = begin;
+    while(true){
+        pos = FindQuoteOrEscape(data, pos, length);
+        if(pos >= length)
+            return false;
+        if(data[pos] == '\"')
             break;
-        }
+        pos += 2;
     }
 
-    if(IsEnd()){
-        throw std::runtime_error("format error: invalid json string, missing closing quote");
-    }
-    Advance();
-
-    this->value_string_ = std::string(temp, current_-1);
+    this->value_string_.assign(data + begin, pos - begin);    //复用已有的容量
+    current_ = json_string_.begin() + pos + 1;
+    return true;
 }
 
 void Scanner::ScanNumber(){
@@ -101,10 +152,16 @@ void Scanner::ScanNumber(){
         }
     }
 
-    value_number_ = std::atof(
-        std::string(temp, current_)
-            .c_str()
-        );
+    //数字通常很短，先复制到栈上的缓冲区，避免构造临时字符串
+    char buffer[64];
+    std::string::difference_type length = current_ - temp;
+    if(length < (std::string::difference_type)sizeof(buffer)){
+        std::copy(temp, current_, buffer);
+        buffer[length] = '\0';
+        value_number_ = std::atof(buffer);
+    }else{
+        value_number_ = std::atof(std::string(temp, current_).c_str());
+    }
 }
 
 bool Scanner::IsDigit(char c){
@@ -124,11 +181,21 @@ char Scanner::PeekNext(){
     return *(current_+1);
 }
 
-JsonTokenType Scanner::Scan()
-{
+JsonTokenType Scanner::Scan(){
+    ErrorCode error = ErrorCode::OK;
+    JsonTokenType token_type = Scan(error);
+    if(error != ErrorCode::OK)
+        ThrowParseError(error);
+    return token_type;
+}
+
+//不抛出格式错误，出错时返回END_OF_FILE并设置error
+JsonTokenType Scanner::Scan(ErrorCode &error){
+    while(!IsEnd() && (*current_ == ' ' || *current_ == '\t' || *current_ == '\n' || *current_ == '\r'))
+        ++current_;
+    last_ = current_;   //记录当前指针，以保证下次Scan可以回滚至当前状态
     if(IsEnd())
         return JsonTokenType::END_OF_FILE;
-    last_ = current_;   //记录当前指针，以保证下次Scan可以回滚至当前状态
     char c = Advance();
     // std::cout << c << std::endl;
     switch(c){
@@ -145,22 +212,25 @@ JsonTokenType Scanner::Scan()
     case ',':
         return JsonTokenType::VALUE_SEPARATOR;
     case 't':
-        ScanTrue();
-        return JsonTokenType::LITERAL_TRUE;
+        if(ScanTrue())
+            return JsonTokenType::LITERAL_TRUE;
+        error = ErrorCode::INVALID_TRUE;
+        return JsonTokenType::END_OF_FILE;
     case 'f':
-        ScanFalse();
-        return JsonTokenType::LITERAL_FALSE;
+        if(ScanFalse())
+            return JsonTokenType::LITERAL_FALSE;
+        error = ErrorCode::INVALID_FALSE;
+        return JsonTokenType::END_OF_FILE;
     case 'n':
-        ScanNull();
-        return JsonTokenType::LITERAL_NULL;
-    case ' ':
-    case '\t':
-    case '\n':
-    case '\r':
-        return Scan();
+        if(ScanNull())
+            return JsonTokenType::LITERAL_NULL;
+        error = ErrorCode::INVALID_NULL;
+        return JsonTokenType::END_OF_FILE;
     case '\"':
-        ScanString();
-        return JsonTokenType::VALUE_STRING;
+        if(ScanString())
+            return JsonTokenType::VALUE_STRING;
+        error = ErrorCode::MISSING_QUOTE;
+        return JsonTokenType::END_OF_FILE;
     case '-':
     case '0':
     case '1':
@@ -175,18 +245,25 @@ JsonTokenType Scanner::Scan()
         ScanNumber();
         return JsonTokenType::VALUE_NUMBER;
     default:
-        throw std::runtime_error("format error: invalid json string");
+        error = ErrorCode::INVALID_VALUE;
+        return JsonTokenType::END_OF_FILE;
     }
 }
 
+Scanner::Scanner()
+    : current_(json_string_.begin()), last_(current_){
+}
+
 Scanner::Scanner(const std::string& json_string)
     : json_string_(json_string){
     current_ = json_string_.begin();
+    last_ = current_;
 }
 
 Scanner::Scanner(const char* json_string)
     : json_string_(json_string){
     current_ = json_string_.begin();
+    last_ = current_;
 }
 
 bool Scanner::get_bool_value() const{
@@ -205,104 +282,353 @@ const std::string& Scanner::get_string_value_quick() const{
     return this->value_string_;
 }
 
+//更换输入，保留json_string_与value_string_已申请的内存
+void Scanner::Reset(const std::string &json_string){
+    json_string_.assign(json_string);
+    current_ = json_string_.begin();
+    last_ = current_;
+}
+
+void Scanner::Reset(const char *json_string){
+    json_string_.assign(json_string);
+    current_ = json_string_.begin();
+    last_ = current_;
+}
+
 //状态回滚
 void Scanner::Rollback(){
     current_ = last_;
 }
 
+unsigned long Scanner::get_position() const{
+    return current_ - json_string_.begin();
+}
+
+unsigned long Scanner::get_token_position() const{
+    return last_ - json_string_.begin();
+}
+
+Parser::Parser()
+    :stats_(nullptr), depth_(0), last_token_(JsonTokenType::END_OF_FILE), error_(ErrorCode::OK), resource_(GetDefaultMemoryResource()), pack_numbers_(false){
+
+}
+
 Parser::Parser(const std::string& json_string)
-    :scanner_(json_string){
+    :scanner_(json_string), stats_(nullptr), depth_(0), last_token_(JsonTokenType::END_OF_FILE), error_(ErrorCode::OK), resource_(GetDefaultMemoryResource()), pack_numbers_(false){
     
 }
 
 Parser::Parser(const char *json_string)
-    :scanner_(json_string){
+    :scanner_(json_string), stats_(nullptr), depth_(0), last_token_(JsonTokenType::END_OF_FILE), error_(ErrorCode::OK), resource_(GetDefaultMemoryResource()), pack_numbers_(false){
+
+}
+
+Parser::Parser(const std::string& json_string, ParseStats *stats)
+    :scanner_(json_string), stats_(stats), depth_(0), last_token_(JsonTokenType::END_OF_FILE), error_(ErrorCode::OK), resource_(GetDefaultMemoryResource()), pack_numbers_(false){
+
+}
+
+Parser::Parser(const char *json_string, ParseStats *stats)
+    :scanner_(json_string), stats_(stats), depth_(0), last_token_(JsonTokenType::END_OF_FILE), error_(ErrorCode::OK), resource_(GetDefaultMemoryResource()), pack_numbers_(false){
+
+}
+
+void Parser::Reset(const std::string &json_string){
+    scanner_.Reset(json_string);
+    depth_ = 0;
+    seen_.clear();
+}
 
+void Parser::Reset(const char *json_string){
+    scanner_.Reset(json_string);
+    depth_ = 0;
+    seen_.clear();
+}
+
+void Parser::set_memory_resource(MemoryResource *resource){
+    resource_ = resource ? resource : GetDefaultMemoryResource();
+}
+
+MemoryResource *Parser::get_memory_resource() const{
+    return resource_;
+}
+
+void Parser::set_pack_numeric_arrays(bool pack){
+    pack_numbers_ = pack;
+}
+
+bool Parser::get_pack_numeric_arrays() const{
+    return pack_numbers_;
 }
 
 Json Parser::Parse(){
-    JsonTokenType token_type = scanner_.Scan();
+    Json json;
+    Parse(json);
+    return json;
+}
+
+void Parser::Parse(Json &json){
+    ParseResult result = TryParse(json);
+    if(!result)
+        ThrowParseError(result.error);
+}
+
+//格式错误只记录在error_中并逐层返回false，不经过异常
+ParseResult Parser::TryParse(Json &json) noexcept{
+    error_ = ErrorCode::OK;
+    depth_ = 0;
+    seen_.clear();
+    try{
+#ifdef JSON_PARSER_STATS
+        if(stats_){
+            StatsScope scope(stats_);
+            StatsClock::time_point start = StatsClock::now();
+            double scan_seconds = stats_->scan_seconds;
+            unsigned long position = scanner_.get_position();
+
+            ParseValue(Scan(), json);
+
+            double total = SecondsSince(start);
+            stats_->total_seconds += total;
+            stats_->build_seconds += total - (stats_->scan_seconds - scan_seconds);
+            stats_->bytes_consumed += scanner_.get_position() - position;
+        }else
+#endif
+        ParseValue(Scan(), json);
+    }catch(const std::bad_alloc &){
+        error_ = ErrorCode::OUT_OF_MEMORY;
+    }
+    if(error_ != ErrorCode::OK)
+        json.type_ = JsonType::JSON_NULL;   //保留已有的缓冲区，供下一次解析复用
+
+    ParseResult result;
+    result.error = error_;
+    result.offset = error_ == ErrorCode::OK ? scanner_.get_position() : scanner_.get_token_position();
+    return result;
+}
+
+bool Parser::Fail(ErrorCode code){
+    if(error_ == ErrorCode::OK)     //保留扫描时已记录的错误
+        error_ = code;
+    return false;
+}
+
+JsonTokenType Parser::Scan(){
+#ifdef JSON_PARSER_STATS
+    if(stats_){
+        unsigned long capacity = scanner_.get_string_value_quick().capacity();
+        StatsClock::time_point start = StatsClock::now();
+        last_token_ = scanner_.Scan(error_);
+        stats_->scan_seconds += SecondsSince(start);
+        ++stats_->token_counts[static_cast<int>(last_token_)];
+        if(last_token_ == JsonTokenType::VALUE_STRING){
+            stats_->string_bytes += scanner_.get_string_value_quick().size();
+            if(scanner_.get_string_value_quick().capacity() != capacity)    //扫描缓冲区扩容
+                RecordStringCopy(scanner_.get_string_value_quick());
+        }else if(last_token_ == JsonTokenType::VALUE_NUMBER){
+            ++stats_->number_count;
+        }
+        return last_token_;
+    }
+#endif
+    return scanner_.Scan(error_);
+}
+
+//json原有的缓冲区只被自身持有时直接复用，否则重新申请，以免影响共享它的其他对象
+bool Parser::ParseValue(JsonTokenType token_type, Json &json){
     switch (token_type)
     {
     case JsonTokenType::END_OF_FILE:
+        if(error_ != ErrorCode::OK)
+            return false;
+        json.type_ = JsonType::JSON_NULL;
+        break;
     case JsonTokenType::LITERAL_NULL:
-        return Json(JsonType::JSON_NULL);
-    case JsonTokenType::VALUE_STRING:
-        return Json(scanner_.get_string_value());
+        json.type_ = JsonType::JSON_NULL;
+        break;
+    case JsonTokenType::VALUE_STRING:{
+        RefPtr<Json::StringBuffer> &buffer = json.value_.string_value;
+        if(buffer && buffer.use_count() == 1 && buffer->resource() == resource_){
+#ifdef JSON_PARSER_STATS
+            unsigned long capacity = buffer->capacity();
+            buffer->assign(scanner_.get_string_value_quick());
+            if(buffer->capacity() != capacity)
+                RecordStringCopy(*buffer);
+#else
+            buffer->assign(scanner_.get_string_value_quick());
+#endif
+        }else{
+            buffer = MakeBuffer<Json::StringBuffer>(resource_, scanner_.get_string_value_quick());
+        }
+        json.type_ = JsonType::JSON_STRING;
+        break;
+    }
     case JsonTokenType::VALUE_NUMBER:
         {
             double temp = scanner_.get_number_value();
-            if (std::ceil(temp) == floor(temp))
-                return Json((int)temp);
-            else
-                return Json(temp);
+            if (std::ceil(temp) == floor(temp) && temp >= INT_MIN && temp <= INT_MAX){    //超出int范围的整数保留为JSON_DOUBLE
+                json.type_ = JsonType::JSON_INT;
+                json.value_.int_value = (int)temp;
+            }else{
+                json.type_ = JsonType::JSON_DOUBLE;
+                json.value_.double_value = temp;
+            }
         }
+        break;
     case JsonTokenType::LITERAL_TRUE:
-        return Json(true);
     case JsonTokenType::LITERAL_FALSE:
-        return Json(false);
+        json.type_ = JsonType::JSON_BOOL;
+        json.value_.bool_value = token_type == JsonTokenType::LITERAL_TRUE;
+        break;
     case JsonTokenType::BEGIN_ARRAY:
-        return ParseArray();
+        return ParseArray(json);
     case JsonTokenType::BEGIN_OBJECT:
-        return ParseObject();
+        return ParseObject(json);
     default:
-        return Json();
+        json = Json();
+        break;
     }
+    return true;
 }
 
-Json Parser::ParseObject(){
-    Json json(JsonType::JSON_OBJECT);
-    JsonTokenType token_type = scanner_.Scan();
-    if(token_type == JsonTokenType::END_OBJECT){
-        return json;
-    }
-    scanner_.Rollback();
-    while(true){
-        token_type = scanner_.Scan();
+bool Parser::ParseObject(Json &json){
+    if(++depth_ > kMaxDepth)    //递归解析，限制深度以免恶意输入耗尽调用栈
+        return Fail(ErrorCode::DEPTH_EXCEEDED);
+    JSON_STATS(if(stats_ && depth_ > stats_->max_depth) stats_->max_depth = depth_);
+    RefPtr<Json::ObjectBuffer> &buffer = json.value_.object_value;
+    if(buffer && buffer.use_count() == 1 && buffer->resource() == resource_)  //只复用位于同一内存资源的缓冲区
+        buffer->Invalidate();
+    else
+        buffer = MakeBuffer<Json::ObjectBuffer>(resource_);
+    json.type_ = JsonType::JSON_OBJECT;
+
+    //已有的键原地复用其值，新键才会申请树节点，最后删除本次未出现的旧键
+    Json::ObjectBuffer &object = *buffer;
+    unsigned long old_size = object.size();
+    unsigned long base = seen_.size();
+    JsonTokenType token_type = Scan();
+    while(token_type != JsonTokenType::END_OBJECT || seen_.size() != base){    //`,`之后的`}`会作为键报错
         if(token_type!=JsonTokenType::VALUE_STRING){
-            throw std::runtime_error("format error: invalid json string, the key must be a string");
+            return Fail(ErrorCode::EXPECTED_KEY);
         }
-        std::string key = scanner_.get_string_value();
-        token_type = scanner_.Scan();
+        const std::string &key = scanner_.get_string_value_quick();
+        Json::ObjectBuffer::iterator it = object.find(key);
+        if(it == object.end()){
+            it = object.insert(std::make_pair(key, Json())).first;
+            JSON_STATS(
+                unsigned long key_heap = StringHeapSize(key);
+                RecordAllocation(key_heap ? 2 : 1, MapNodeSize() + key_heap)
+            );
+        }
+        token_type = Scan();
         if(token_type != JsonTokenType::NAME_SEPARATOR){
-            throw std::runtime_error("format error: invalid json string, expected `:`");
+            return Fail(ErrorCode::EXPECTED_COLON);
         }
-        json[key] = Parse();    //递归解析
+        if(!ParseValue(Scan(), it->second))    //递归解析
+            return false;
+        seen_.push_back(&it->second);
 
-        token_type = scanner_.Scan();
+        token_type = Scan();
         if(token_type == JsonTokenType::END_OBJECT){
             break;
         }
 
         if(token_type != JsonTokenType::VALUE_SEPARATOR){
-            throw std::runtime_error("format error: invalid json string, expected `,`");
+            return Fail(ErrorCode::EXPECTED_COMMA);
         }
+        token_type = Scan();
     }
-    return json;
+
+    //键可能重复，因此需要去重后才能判断旧键是否都已出现
+    if(old_size > 0){
+        std::vector<const Json *>::iterator first = seen_.begin() + base;
+        std::sort(first, seen_.end());
+        if((unsigned long)(std::unique(first, seen_.end()) - first) != object.size()){
+            for(Json::ObjectBuffer::iterator it = object.begin(); it != object.end();){
+                if(std::binary_search(first, seen_.end(), &it->second))
+                    ++it;
+                else
+                    it = object.erase(it);
+            }
+        }
+    }
+    seen_.resize(base);
+    --depth_;
+    return true;
 }
 
-Json Parser::ParseArray(){
-    Json json(JsonType::JSON_ARRAY);
-    JsonTokenType token_type = scanner_.Scan();
-    if(token_type == JsonTokenType::END_ARRAY){
-        return json;
+bool Parser::ParseArray(Json &json){
+    if(++depth_ > kMaxDepth)    //递归解析，限制深度以免恶意输入耗尽调用栈
+        return Fail(ErrorCode::DEPTH_EXCEEDED);
+    JSON_STATS(if(stats_ && depth_ > stats_->max_depth) stats_->max_depth = depth_);
+    RefPtr<Json::ArrayBuffer> &buffer = json.value_.array_value;
+    if(buffer && buffer.use_count() == 1 && buffer->resource() == resource_)  //只复用位于同一内存资源的缓冲区
+        buffer->Invalidate();
+    else
+        buffer = MakeBuffer<Json::ArrayBuffer>(resource_);
+    json.type_ = JsonType::JSON_ARRAY;
+
+    Json::ArrayBuffer &array = *buffer;
+    unsigned long count = 0;
+    JsonTokenType token_type = Scan();
+    if(pack_numbers_ && token_type == JsonTokenType::VALUE_NUMBER){
+        //以数字开头时先按紧凑数组解析，全部是数字时不创建任何元素
+        array.BeginNumbers();
+        do{
+#ifdef JSON_PARSER_STATS
+            unsigned long bytes = array.NumberBytes();
+            array.PushNumber(scanner_.get_number_value());
+            if(array.NumberBytes() > bytes)    //扩容
+                RecordAllocation(1, array.NumberBytes());
+#else
+            array.PushNumber(scanner_.get_number_value());
+#endif
+            token_type = Scan();
+            if(token_type == JsonTokenType::END_ARRAY){
+                --depth_;
+                return true;
+            }
+            if(token_type != JsonTokenType::VALUE_SEPARATOR){
+                return Fail(ErrorCode::EXPECTED_COMMA);
+            }
+            token_type = Scan();
+        }while(token_type == JsonTokenType::VALUE_NUMBER);
+        count = array.MutableElements().size();  //出现了其他元素，已解析的数字展开为普通元素
+    }else{
+        array.DropNumbers();
     }
-    scanner_.Rollback();
 
-    while(true){
-        json.Append(Parse());
-        token_type = scanner_.Scan();
+    //直接写入缓冲区，已有的元素原地复用
+    JsonVector &elements = array.MutableElements();
+    while(token_type != JsonTokenType::END_ARRAY || count != 0){   //与此前一致，`,`之后的`]`被解析为null
+        if(count == elements.size()){
+#ifdef JSON_PARSER_STATS
+            unsigned long capacity = elements.capacity();
+            elements.emplace_back();
+            if(elements.capacity() != capacity)    //扩容
+                RecordAllocation(1, elements.capacity() * sizeof(Json));
+#else
+            elements.emplace_back();
+#endif
+        }
+        if(!ParseValue(token_type, elements[count++]))
+            return false;
+        token_type = Scan();
 
         if(token_type == JsonTokenType::END_ARRAY){
             break;
         }
 
         if(token_type != JsonTokenType::VALUE_SEPARATOR){
-            throw std::runtime_error("format error: invalid json string, expected `,`");
+            return Fail(ErrorCode::EXPECTED_COMMA);
         }
+        token_type = Scan();
     }
+    if(elements.size() > count)
+        elements.erase(elements.begin() + count, elements.end());
 
-    return json;
+    --depth_;
+    return true;
 }
 
-}
\ No newline at end of file
+}
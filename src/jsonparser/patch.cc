@@ -0,0 +1,226 @@
+#include "jsonparser/json.h"
+#include "json_internal.h"
+#include <stdexcept>
+
+namespace json_parser{
+namespace{
+//RFC 6901 Json Pointer，空串表示整个文档
+std::vector<std::string> ParsePointer(const std::string &pointer){
+    std::vector<std::string> path;
+    if(pointer.empty())
+        return path;
+    if(pointer[0] != '/')
+        throw std::logic_error("patch error: invalid json pointer `" + pointer + "`");
+
+    std::string token;
+    for(std::string::size_type i = 1; i <= pointer.size(); i++){
+        if(i == pointer.size() || pointer[i] == '/'){
+            path.push_back(token);
+            token.clear();
+        }else if(pointer[i] != '~'){
+            token += pointer[i];
+        }else if(i + 1 < pointer.size() && (pointer[i + 1] == '0' || pointer[i + 1] == '1')){
+            token += pointer[++i] == '0' ? '~' : '/';
+        }else{
+            throw std::logic_error("patch error: invalid escape in json pointer `" + pointer + "`");
+        }
+    }
+    return path;
+}
+
+//数组下标，允许时`-`表示数组末尾之后的位置
+unsigned long ParseIndex(const std::string &token, unsigned long size, bool allow_end){
+    if(allow_end && token == "-")
+        return size;
+    if(token.empty() || token.size() > 9 || (token.size() > 1 && token[0] == '0'))
+        throw std::logic_error("patch error: invalid array index `" + token + "`");
+
+    unsigned long index = 0;
+    for(std::string::size_type i = 0; i < token.size(); i++){
+        if(token[i] < '0' || token[i] > '9')
+            throw std::logic_error("patch error: invalid array index `" + token + "`");
+        index = index * 10 + (token[i] - '0');
+    }
+    return index;
+}
+
+const Json &Member(const Json &operation, const char *key){
+    if(!operation.FindKey(key))
+        throw std::logic_error(std::string("patch error: the operation has no member `") + key + "`");
+    return operation[key];
+}
+
+bool IsProperPrefix(const std::vector<std::string> &prefix, const std::vector<std::string> &path){
+    if(prefix.size() >= path.size())
+        return false;
+    for(unsigned long i = 0; i < prefix.size(); i++){
+        if(prefix[i] != path[i])
+            return false;
+    }
+    return true;
+}
+}
+
+const Json& Json::Resolve(const std::vector<std::string>& path) const{
+    const Json *json = this;
+    for(auto it = path.begin(); it != path.end(); it++){
+        if(json->type_ == JsonType::JSON_OBJECT){
+            auto found = json->value_.object_value->find(*it);
+            if(found == json->value_.object_value->end())
+                throw std::logic_error("patch error: the path does not exist");
+            json = &found->second;
+        }else if(json->type_ == JsonType::JSON_ARRAY){
+            unsigned long index = ParseIndex(*it, json->value_.array_value->size(), false);
+            if(index >= json->value_.array_value->size())
+                throw std::logic_error("patch error: the path does not exist");
+            json = &json->value_.array_value->Elements()[index];
+        }else{
+            throw std::logic_error("patch error: the path does not exist");
+        }
+    }
+    return *json;
+}
+
+//沿路径递归，每一层只复制当前容器本身，其中的子节点仍与原文档共享
+Json Json::PatchPath(const std::vector<std::string>& path, unsigned long depth,
+                     PatchMode mode, const Json& value) const{
+    if(depth == path.size()){
+        if(mode == PatchMode::REMOVE)
+            throw std::logic_error("patch error: cannot remove the whole document");
+        Json result;
+        result.DeepCopy(value, GetMemoryResource());    //不与补丁共享
+        return result;
+    }
+
+    const std::string &token = path[depth];
+    bool last = depth + 1 == path.size();
+    Json result;
+    result.type_ = type_;
+
+    switch(type_){
+    case JsonType::JSON_OBJECT:
+        {
+            auto found = value_.object_value->find(token);
+            if(found == value_.object_value->end() && !(last && mode == PatchMode::ADD))
+                throw std::logic_error("patch error: the path does not exist");
+
+            //与Append一致，写入的值逐层深拷贝到容器所在的内存资源，不与补丁共享
+            Json child;
+            if(last)
+                child.DeepCopy(value, value_.object_value->resource());
+            else
+                child = found->second.PatchPath(path, depth + 1, mode, value);
+            result.value_.object_value = CopyShared(*value_.object_value);
+            if(last && mode == PatchMode::REMOVE)
+                result.value_.object_value->erase(token);
+            else
+                (*result.value_.object_value)[token] = child;
+            return result;
+        }
+    case JsonType::JSON_ARRAY:
+        {
+            unsigned long size = value_.array_value->size();
+            bool insert = last && mode == PatchMode::ADD;
+            unsigned long index = ParseIndex(token, size, insert);
+            if(index > size || (index == size && !insert))
+                throw std::logic_error("patch error: the array index out of range");
+
+            Json child;
+            if(last)
+                child.DeepCopy(value, value_.array_value->resource());
+            else
+                child = value_.array_value->Elements()[index].PatchPath(path, depth + 1, mode, value);
+            result.value_.array_value = CopyShared(*value_.array_value);
+            JsonVector &array = result.value_.array_value->MutableElements();
+            if(insert)
+                array.insert(array.begin() + index, child);
+            else if(last && mode == PatchMode::REMOVE)
+                array.erase(array.begin() + index);
+            else
+                array[index] = child;
+            return result;
+        }
+    default:
+        throw std::logic_error("patch error: the path does not exist");
+    }
+}
+
+//任意一步失败都会抛出异常，原文档不受影响
+Json Json::ApplyPatch(const Json& patch) const{
+    if(patch.type_ != JsonType::JSON_ARRAY)
+        throw std::logic_error("patch error: the patch must be a json array");
+
+    Json document = *this;
+    const JsonVector &operations = patch.value_.array_value->Elements();
+    for(auto it = operations.begin(); it != operations.end(); it++){
+        if(!it->IsObject())
+            throw std::logic_error("patch error: the operation must be a json object");
+
+        std::string op = Member(*it, "op");
+        std::vector<std::string> path = ParsePointer(Member(*it, "path"));
+        if(op == "add"){
+            document = document.PatchPath(path, 0, PatchMode::ADD, Member(*it, "value"));
+        }else if(op == "remove"){
+            document = document.PatchPath(path, 0, PatchMode::REMOVE, Json());
+        }else if(op == "replace"){
+            document = document.PatchPath(path, 0, PatchMode::REPLACE, Member(*it, "value"));
+        }else if(op == "move" || op == "copy"){
+            std::vector<std::string> from = ParsePointer(Member(*it, "from"));
+            Json value = document.Resolve(from);
+            if(op == "move"){
+                if(IsProperPrefix(from, path))
+                    throw std::logic_error("patch error: cannot move a value into its own child");
+                if(from == path)
+                    continue;
+                document = document.PatchPath(from, 0, PatchMode::REMOVE, Json());
+            }
+            document = document.PatchPath(path, 0, PatchMode::ADD, value);
+        }else if(op == "test"){
+            if(!document.Resolve(path).Equal(Member(*it, "value")))
+                throw std::logic_error("patch error: test failed");
+        }else{
+            throw std::logic_error("patch error: unknown operation `" + op + "`");
+        }
+    }
+    return document;
+}
+
+Json Json::ApplyMergePatch(const Json& patch) const{
+    if(patch.type_ != JsonType::JSON_OBJECT){
+        Json result;
+        result.DeepCopy(patch, GetMemoryResource());   //不与补丁共享
+        return result;
+    }
+
+    Json result = type_ == JsonType::JSON_OBJECT ? *this : Json(JsonType::JSON_OBJECT);
+    bool exclusive = type_ != JsonType::JSON_OBJECT;    //新建的对象无需再复制
+    for(auto it = patch.value_.object_value->begin(); it != patch.value_.object_value->end(); it++){
+        auto found = result.value_.object_value->find(it->first);
+        bool exists = found != result.value_.object_value->end();
+        if(it->second.IsNull() && !exists)
+            continue;
+
+        MemoryResource *resource = result.value_.object_value->resource();
+        Json child;
+        if(!it->second.IsNull()){
+            if(exists && found->second.IsObject())
+                child = found->second.ApplyMergePatch(it->second);
+            else if(it->second.IsObject())
+                child = Json(JsonType::JSON_OBJECT, resource).ApplyMergePatch(it->second);
+            else
+                child.DeepCopy(it->second, resource);
+        }
+
+        if(!exclusive){
+            result.value_.object_value = CopyShared(*result.value_.object_value);
+            exclusive = true;
+        }
+        if(it->second.IsNull())
+            result.value_.object_value->erase(it->first);
+        else
+            (*result.value_.object_value)[it->first] = child;
+    }
+    return result;
+}
+
+}
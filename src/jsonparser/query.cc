@@ -0,0 +1,306 @@
+#include "jsonparser/query.h"
+#include "jsonparser/parser.h"
+#include "json_internal.h"
+#include "simd_internal.h"
+#include <stdexcept>
+
+namespace json_parser{
+namespace{
+[[noreturn]] void InvalidExpression(){
+    throw std::logic_error("query error: invalid path expression");
+}
+
+bool IsDigit(char c){
+    return c >= '0' && c <= '9';
+}
+}
+
+PathQuery::PathQuery(const std::string &expression){
+    if(expression.empty() || expression[0] != '$')
+        InvalidExpression();
+
+    std::string::size_type pos = 1;
+    while(pos < expression.size()){
+        Step step;
+        step.index = 0;
+        if(expression[pos] == '.'){
+            ++pos;
+            if(pos < expression.size() && expression[pos] == '*'){
+                step.type = StepType::WILDCARD;
+                ++pos;
+            }else{
+                std::string::size_type end = expression.find_first_of(".[", pos);
+                if(end == std::string::npos)
+                    end = expression.size();
+                if(end == pos)
+                    InvalidExpression();
+                step.type = StepType::KEY;
+                step.key = expression.substr(pos, end - pos);
+                pos = end;
+            }
+        }else if(expression[pos] == '['){
+            ++pos;
+            if(pos >= expression.size())
+                InvalidExpression();
+            char c = expression[pos];
+            if(c == '*'){
+                step.type = StepType::WILDCARD;
+                ++pos;
+            }else if(IsDigit(c)){
+                step.type = StepType::INDEX;
+                while(pos < expression.size() && IsDigit(expression[pos]))
+                    step.index = step.index * 10 + (expression[pos++] - '0');
+            }else if(c == '\'' || c == '\"'){
+                //引号内的`\`转义下一个字符
+                step.type = StepType::KEY;
+                ++pos;
+                while(pos < expression.size() && expression[pos] != c){
+                    if(expression[pos] == '\\' && pos + 1 < expression.size())
+                        ++pos;
+                    step.key += expression[pos++];
+                }
+                if(pos >= expression.size())
+                    InvalidExpression();
+                ++pos;
+            }else{
+                InvalidExpression();
+            }
+            if(pos >= expression.size() || expression[pos] != ']')
+                InvalidExpression();
+            ++pos;
+        }else{
+            InvalidExpression();
+        }
+        steps_.push_back(step);
+    }
+}
+
+//在输入块之间移动并沿路径下降，递归深度不超过路径的长度
+class PathQuery::Evaluator{
+public:
+    Evaluator(const std::vector<Step> &steps, ChunkReader &reader, const Callback &callback)
+        : steps_(steps), reader_(reader), callback_(callback),
+          pos_(nullptr), end_(nullptr), mark_(nullptr), capture_(nullptr), count_(0){}
+
+    unsigned long Run(){
+        Walk(0);
+        if(SkipWhitespace() >= 0)
+            ThrowParseError(ErrorCode::TRAILING_CHARACTERS);
+        return count_;
+    }
+
+private:
+    //当前块用完时读取下一块，输入结束时返回false
+    bool Fill(){
+        if(pos_ < end_)
+            return true;
+        Flush();
+        const char *data;
+        unsigned long size = reader_.Read(data);
+        if(size == 0)
+            return false;
+        pos_ = data;
+        end_ = data + size;
+        mark_ = data;
+        return true;
+    }
+
+    //捕获时把当前块中尚未保存的部分追加到capture_
+    void Flush(){
+        if(capture_ && pos_ > mark_)
+            capture_->append(mark_, pos_ - mark_);
+        mark_ = pos_;
+    }
+
+    int SkipWhitespace(){
+        while(Fill()){
+            while(pos_ < end_ && IsWhitespace(*pos_))
+                ++pos_;
+            if(pos_ < end_)
+                return (unsigned char)*pos_;
+        }
+        return -1;
+    }
+
+    //pos_位于开头的`"`之后，output非空时写入字符串的原始内容
+    void SkipString(std::string *output){
+        while(true){
+            if(!Fill())
+                ThrowParseError(ErrorCode::MISSING_QUOTE);
+            const char *found = pos_ + FindQuoteOrEscape(pos_, 0, end_ - pos_);
+            if(output)
+                output->append(pos_, found - pos_);
+            pos_ = found;
+            if(pos_ == end_)
+                continue;
+            if(*pos_ == '\"'){
+                ++pos_;
+                return;
+            }
+            //转义序列可能跨越两个块
+            ++pos_;
+            if(!Fill())
+                ThrowParseError(ErrorCode::MISSING_QUOTE);
+            if(output){
+                output->push_back('\\');
+                output->push_back(*pos_);
+            }
+            ++pos_;
+        }
+    }
+
+    //pos_位于容器内部，跳到深度为0的闭合括号之后
+    void SkipContainer(unsigned long depth){
+        while(true){
+            if(!Fill())
+                ThrowParseError(ErrorCode::UNEXPECTED_END);
+            pos_ += FindQuoteOrBracket(pos_, 0, end_ - pos_);
+            if(pos_ == end_)
+                continue;
+            char c = *pos_++;
+            if(c == '\"')
+                SkipString(nullptr);
+            else if(c == '[' || c == '{')
+                ++depth;
+            else if(--depth == 0)
+                return;
+        }
+    }
+
+    void SkipValue(){
+        int c = SkipWhitespace();
+        if(c < 0)
+            ThrowParseError(ErrorCode::UNEXPECTED_END);
+        if(c == '\"'){
+            ++pos_;
+            SkipString(nullptr);
+            return;
+        }
+        if(c == '[' || c == '{'){
+            ++pos_;
+            SkipContainer(1);
+            return;
+        }
+        if(c == ',' || c == ']' || c == '}' || c == ':')
+            ThrowParseError(ErrorCode::INVALID_VALUE);
+        //数字与字面量，读到分隔符为止
+        while(Fill()){
+            while(pos_ < end_){
+                c = *pos_;
+                if(c == ',' || c == ']' || c == '}' || IsWhitespace(c))
+                    return;
+                ++pos_;
+            }
+        }
+    }
+
+    void Emit(){
+        text_.clear();
+        capture_ = &text_;
+        mark_ = pos_;
+        SkipValue();
+        Flush();
+        capture_ = nullptr;
+
+        parser_.Reset(text_);
+        parser_.Parse(value_);
+        ++count_;
+        callback_(value_);
+    }
+
+    void Walk(unsigned long depth){
+        int c = SkipWhitespace();
+        if(c < 0)
+            ThrowParseError(ErrorCode::UNEXPECTED_END);
+        if(depth == steps_.size()){
+            Emit();
+            return;
+        }
+
+        const Step &step = steps_[depth];
+        if(c == '{' && step.type != StepType::INDEX){
+            ++pos_;
+            c = SkipWhitespace();
+            if(c == '}'){
+                ++pos_;
+                return;
+            }
+            while(true){
+                if(c != '\"')
+                    ThrowParseError(ErrorCode::EXPECTED_KEY);
+                ++pos_;
+                key_.clear();
+                SkipString(&key_);  //与Json对象一致，键按原文比较，不解码转义
+                if(SkipWhitespace() != ':')
+                    ThrowParseError(ErrorCode::EXPECTED_COLON);
+                ++pos_;
+                if(step.type == StepType::WILDCARD || key_ == step.key)
+                    Walk(depth + 1);
+                else
+                    SkipValue();
+
+                c = SkipWhitespace();
+                if(c == '}'){
+                    ++pos_;
+                    return;
+                }
+                if(c != ',')
+                    ThrowParseError(ErrorCode::EXPECTED_COMMA);
+                ++pos_;
+                c = SkipWhitespace();
+            }
+        }else if(c == '[' && step.type != StepType::KEY){
+            ++pos_;
+            if(SkipWhitespace() == ']'){
+                ++pos_;
+                return;
+            }
+            for(unsigned long index = 0; ; index++){
+                if(step.type == StepType::WILDCARD){
+                    Walk(depth + 1);
+                }else if(index == step.index){
+                    Walk(depth + 1);
+                    SkipContainer(1);   //之后的元素不会再匹配
+                    return;
+                }else{
+                    SkipValue();
+                }
+
+                c = SkipWhitespace();
+                if(c == ']'){
+                    ++pos_;
+                    return;
+                }
+                if(c != ',')
+                    ThrowParseError(ErrorCode::EXPECTED_COMMA);
+                ++pos_;
+            }
+        }else{
+            SkipValue();
+        }
+    }
+
+    const std::vector<Step> &steps_;
+    ChunkReader &reader_;
+    const Callback &callback_;
+    const char *pos_;
+    const char *end_;
+    const char *mark_;          //当前块中尚未追加到capture_的起点
+    std::string *capture_;
+    std::string key_;
+    std::string text_;          //匹配的值的原始文本
+    Parser parser_;
+    Json value_;
+    unsigned long count_;
+};
+
+unsigned long PathQuery::Run(ChunkReader &reader, const Callback &callback) const{
+    Evaluator evaluator(steps_, reader, callback);
+    return evaluator.Run();
+}
+
+unsigned long PathQuery::Run(const std::string &json_string, const Callback &callback) const{
+    MemoryChunkReader reader(json_string, json_string.size());
+    return Run(reader, callback);
+}
+}
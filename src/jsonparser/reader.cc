@@ -0,0 +1,108 @@
+#include "jsonparser/reader.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace json_parser{
+
+ChunkReader::~ChunkReader(){
+
+}
+
+MemoryChunkReader::MemoryChunkReader(const char *data, unsigned long length, unsigned long chunk_size)
+    : data_(data), length_(length), pos_(0), chunk_size_(chunk_size ? chunk_size : 1){
+
+}
+
+MemoryChunkReader::MemoryChunkReader(const std::string &data, unsigned long chunk_size)
+    : MemoryChunkReader(data.data(), data.size(), chunk_size){
+
+}
+
+unsigned long MemoryChunkReader::Read(const char *&data){
+    unsigned long size = std::min(chunk_size_, length_ - pos_);
+    data = data_ + pos_;
+    pos_ += size;
+    return size;
+}
+
+FdChunkReader::FdChunkReader(int fd, unsigned long buffer_size)
+    : fd_(fd), buffer_(buffer_size ? buffer_size : 1){
+
+}
+
+unsigned long FdChunkReader::Read(const char *&data){
+    while(true){
+#ifdef _WIN32
+        int size = ::_read(fd_, buffer_.data(), (unsigned)std::min(buffer_.size(), (std::size_t)INT_MAX));
+#else
+        ssize_t size = ::read(fd_, buffer_.data(), buffer_.size());
+#endif
+        if(size < 0){
+            if(errno == EINTR)
+                continue;
+            throw std::runtime_error("io error: read failed");
+        }
+        data = buffer_.data();
+        return size;
+    }
+}
+
+#ifndef _WIN32
+MappedFileReader::MappedFileReader(const std::string &path, unsigned long chunk_size)
+    : fd_(-1), data_(nullptr), size_(0), pos_(0), released_(0), chunk_size_(chunk_size ? chunk_size : 1){
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if(fd_ < 0)
+        throw std::runtime_error("io error: cannot open " + path);
+    struct stat st;
+    if(::fstat(fd_, &st) != 0){
+        ::close(fd_);
+        throw std::runtime_error("io error: cannot stat " + path);
+    }
+    size_ = st.st_size;
+    if(size_ == 0)
+        return;     //空文件不能映射
+    void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if(data == MAP_FAILED){
+        ::close(fd_);
+        throw std::runtime_error("io error: cannot map " + path);
+    }
+    data_ = static_cast<char *>(data);
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+MappedFileReader::~MappedFileReader(){
+    if(data_)
+        ::munmap(data_, size_);
+    ::close(fd_);
+}
+
+unsigned long MappedFileReader::Read(const char *&data){
+    //上一块已不再使用，归还其中完整的页
+    unsigned long page = ::sysconf(_SC_PAGESIZE);
+    unsigned long done = pos_ / page * page;
+    if(done > released_){
+        ::madvise(data_ + released_, done - released_, MADV_DONTNEED);
+        released_ = done;
+    }
+
+    unsigned long size = std::min(chunk_size_, size_ - pos_);
+    data = data_ + pos_;
+    pos_ += size;
+    return size;
+}
+
+unsigned long MappedFileReader::size() const{
+    return size_;
+}
+#endif
+}
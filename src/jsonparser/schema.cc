@@ -0,0 +1,564 @@
+#include "jsonparser/schema.h"
+#include "jsonparser/bind.h"
+#include "json_internal.h"
+#include <climits>
+#include <cmath>
+#include <regex>
+#include <stdexcept>
+#include <vector>
+
+namespace json_parser{
+namespace{
+enum TypeMask{
+    TYPE_NULL = 1,
+    TYPE_BOOLEAN = 2,
+    TYPE_INTEGER = 4,
+    TYPE_NUMBER = 8,
+    TYPE_STRING = 16,
+    TYPE_ARRAY = 32,
+    TYPE_OBJECT = 64,
+};
+
+const unsigned long kUnlimited = (unsigned long)-1;
+const unsigned long kMaxDepth = 4096;   //与Parser、Validate的嵌套深度上限一致
+
+unsigned TypeFromName(const std::string &name){
+    if(name == "null")
+        return TYPE_NULL;
+    if(name == "boolean")
+        return TYPE_BOOLEAN;
+    if(name == "integer")
+        return TYPE_INTEGER;
+    if(name == "number")
+        return TYPE_NUMBER;
+    if(name == "string")
+        return TYPE_STRING;
+    if(name == "array")
+        return TYPE_ARRAY;
+    if(name == "object")
+        return TYPE_OBJECT;
+    throw std::logic_error("schema error: unknown type `" + name + "`");
+}
+
+//整数同时也是number
+unsigned NumberType(double value){
+    return value == std::floor(value) ? (TYPE_INTEGER | TYPE_NUMBER) : TYPE_NUMBER;
+}
+
+double NumberValue(const Json &json){
+    return json.IsInt() ? (double)(int)json : (double)json;
+}
+
+double KeywordNumber(const Json &value, const std::string &keyword){
+    if(!value.IsNumber())
+        throw std::logic_error("schema error: `" + keyword + "` must be a number");
+    return NumberValue(value);
+}
+
+unsigned long KeywordCount(const Json &value, const std::string &keyword){
+    if(!value.IsNumber() || NumberValue(value) < 0 || !(NumberType(NumberValue(value)) & TYPE_INTEGER))
+        throw std::logic_error("schema error: `" + keyword + "` must be a non-negative integer");
+    return (unsigned long)NumberValue(value);
+}
+
+unsigned HexValue(const std::string &raw, std::string::size_type pos){
+    unsigned value = 0;
+    for(std::string::size_type i = pos; i < pos + 4 && i < raw.size(); i++){
+        char c = raw[i];
+        value <<= 4;
+        if(c >= '0' && c <= '9')
+            value |= c - '0';
+        else if(c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+    }
+    return value;
+}
+
+//字符串以未解码转义的形式保存，按Unicode码点计算长度，代理对算作一个字符
+unsigned long CountCharacters(const std::string &raw){
+    unsigned long count = 0;
+    std::string::size_type i = 0;
+    while(i < raw.size()){
+        unsigned char c = raw[i];
+        if(c == '\\' && i + 1 < raw.size()){
+            if(raw[i + 1] == 'u'){
+                unsigned code = HexValue(raw, i + 2);
+                i += 6;
+                if(code >= 0xD800 && code <= 0xDBFF && i + 1 < raw.size() && raw[i] == '\\' && raw[i + 1] == 'u'){
+                    unsigned low = HexValue(raw, i + 2);
+                    if(low >= 0xDC00 && low <= 0xDFFF)
+                        i += 6;
+                }
+            }else{
+                i += 2;
+            }
+        }else{
+            ++i;
+            while(i < raw.size() && (static_cast<unsigned char>(raw[i]) & 0xC0) == 0x80)
+                ++i;    //UTF-8的后续字节
+        }
+        ++count;
+    }
+    return count;
+}
+
+//从已扫描的记号开始构建一个值，只用于需要比较enum的子树；depth为所在容器的嵌套层数
+Json BuildValue(Scanner &scanner, JsonTokenType token_type, unsigned long depth){
+    if((token_type == JsonTokenType::BEGIN_ARRAY || token_type == JsonTokenType::BEGIN_OBJECT) && depth >= kMaxDepth)
+        throw std::runtime_error(ErrorMessage(ErrorCode::DEPTH_EXCEEDED));     //递归构建，限制深度以免耗尽调用栈
+    switch(token_type){
+    case JsonTokenType::LITERAL_NULL:
+        return Json(JsonType::JSON_NULL);
+    case JsonTokenType::LITERAL_TRUE:
+        return Json(true);
+    case JsonTokenType::LITERAL_FALSE:
+        return Json(false);
+    case JsonTokenType::VALUE_STRING:
+        return Json(scanner.get_string_value());
+    case JsonTokenType::VALUE_NUMBER:{
+        double temp = scanner.get_number_value();
+        if(std::ceil(temp) == std::floor(temp) && temp >= INT_MIN && temp <= INT_MAX)    //与Parser一致
+            return Json((int)temp);
+        return Json(temp);
+    }
+    case JsonTokenType::BEGIN_ARRAY:{
+        Json json(JsonType::JSON_ARRAY);
+        token_type = scanner.Scan();
+        if(token_type == JsonTokenType::END_ARRAY)
+            return json;
+        while(true){
+            json.Append(BuildValue(scanner, token_type, depth + 1));
+            token_type = scanner.Scan();
+            if(token_type == JsonTokenType::END_ARRAY)
+                return json;
+            if(token_type != JsonTokenType::VALUE_SEPARATOR)
+                throw std::runtime_error("format error: invalid json string, expected `,`");
+            token_type = scanner.Scan();
+        }
+    }
+    case JsonTokenType::BEGIN_OBJECT:{
+        Json json(JsonType::JSON_OBJECT);
+        token_type = scanner.Scan();
+        if(token_type == JsonTokenType::END_OBJECT)
+            return json;
+        while(true){
+            if(token_type != JsonTokenType::VALUE_STRING)
+                throw std::runtime_error("format error: invalid json string, the key must be a string");
+            std::string key = scanner.get_string_value();
+            ExpectToken(scanner, JsonTokenType::NAME_SEPARATOR, "format error: invalid json string, expected `:`");
+            json[key] = BuildValue(scanner, scanner.Scan(), depth + 1);
+            token_type = scanner.Scan();
+            if(token_type == JsonTokenType::END_OBJECT)
+                return json;
+            if(token_type != JsonTokenType::VALUE_SEPARATOR)
+                throw std::runtime_error("format error: invalid json string, expected `,`");
+            token_type = scanner.Scan();
+        }
+    }
+    case JsonTokenType::END_OF_FILE:
+        throw std::runtime_error("format error: invalid json string, unexpected end");
+    default:
+        throw std::runtime_error("format error: invalid json string");
+    }
+}
+
+bool Fail(SchemaResult &result, const std::string &message){
+    result.valid = false;
+    result.message = message;
+    return false;
+}
+
+//错误从内层向外层返回时逐级补全路径
+void PrependPath(SchemaResult &result, const std::string &token){
+    result.path.insert(0, "/" + EscapeToken(token));
+}
+}
+
+struct Schema::Node{
+    struct Member{
+        Member() : node(-1), required(-1){}
+
+        int node;       //属性对应的子Schema，-1表示没有
+        int required;   //在required中的下标，-1表示不是必需的
+    };
+
+    Node()
+        : reject(false), trivial(false), types(0), has_enum(false), has_pattern(false),
+          minimum(-HUGE_VAL), maximum(HUGE_VAL), exclusive_minimum(-HUGE_VAL), exclusive_maximum(HUGE_VAL),
+          min_length(0), max_length(kUnlimited), min_items(0), max_items(kUnlimited),
+          min_properties(0), max_properties(kUnlimited), items(-1){}
+
+    bool reject;    //false schema
+    bool trivial;   //没有任何约束，扫描时直接跳过
+    unsigned types; //TypeMask的组合，0表示任意类型
+    bool has_enum;
+    bool has_pattern;
+
+    double minimum;
+    double maximum;
+    double exclusive_minimum;
+    double exclusive_maximum;
+    unsigned long min_length;
+    unsigned long max_length;
+    unsigned long min_items;
+    unsigned long max_items;
+    unsigned long min_properties;
+    unsigned long max_properties;
+
+    int items;
+    std::vector<std::string> required;
+    std::map<std::string, Member> members;
+    std::vector<Json> enum_values;
+    std::regex pattern;
+};
+
+//所有节点保存在一个数组中，以下标互相引用
+struct Schema::Program{
+    std::vector<Node> nodes;
+
+    int Compile(const Json &schema);
+    bool Check(int index, const Json &json, SchemaResult &result) const;
+    bool Stream(int index, Scanner &scanner, SchemaResult &result) const;
+
+    static bool CheckType(const Node &node, unsigned type, SchemaResult &result);
+    static bool CheckNumber(const Node &node, double value, SchemaResult &result);
+    static bool CheckString(const Node &node, const std::string &raw, SchemaResult &result);
+    static bool CheckCount(unsigned long count, unsigned long min, unsigned long max,
+                           const char *what, SchemaResult &result);
+    static bool InEnum(const Node &node, const Json &json);
+};
+
+int Schema::Program::Compile(const Json &schema){
+    int index = nodes.size();
+    nodes.push_back(Node());
+    if(schema.IsBool()){
+        nodes[index].reject = !(bool)schema;
+        nodes[index].trivial = (bool)schema;
+        return index;
+    }
+    if(!schema.IsObject())
+        throw std::logic_error("schema error: the schema must be a json object or a bool");
+
+    //子Schema编译时会扩充nodes，因此先在局部对象上填充
+    Node node;
+    bool constrained = false;
+    const Json::ObjectBuffer &keywords = Schema::Members(schema);
+    for(auto it = keywords.begin(); it != keywords.end(); it++){
+        const std::string &keyword = it->first;
+        const Json &value = it->second;
+        if(keyword == "type"){
+            if(value.IsString()){
+                node.types = TypeFromName(Schema::Text(value));
+            }else if(value.IsArray()){
+                for(const Json &name : value){
+                    if(!name.IsString())
+                        throw std::logic_error("schema error: `type` must be a string or an array of strings");
+                    node.types |= TypeFromName(Schema::Text(name));
+                }
+            }else{
+                throw std::logic_error("schema error: `type` must be a string or an array of strings");
+            }
+            if(node.types & TYPE_NUMBER)
+                node.types |= TYPE_INTEGER;
+        }else if(keyword == "required"){
+            if(!value.IsArray())
+                throw std::logic_error("schema error: `required` must be an array of strings");
+            for(const Json &name : value){
+                if(!name.IsString())
+                    throw std::logic_error("schema error: `required` must be an array of strings");
+                node.required.push_back(Schema::Text(name));
+            }
+        }else if(keyword == "properties"){
+            if(!value.IsObject())
+                throw std::logic_error("schema error: `properties` must be a json object");
+            const Json::ObjectBuffer &properties = Schema::Members(value);
+            for(auto jt = properties.begin(); jt != properties.end(); jt++)
+                node.members[jt->first].node = Compile(jt->second);
+        }else if(keyword == "items"){
+            node.items = Compile(value);
+        }else if(keyword == "enum"){
+            if(!value.IsArray())
+                throw std::logic_error("schema error: `enum` must be an array");
+            node.enum_values.assign(value.begin(), value.end());
+            node.has_enum = true;
+        }else if(keyword == "pattern"){
+            if(!value.IsString())
+                throw std::logic_error("schema error: `pattern` must be a string");
+            try{
+                node.pattern = std::regex(Schema::Text(value), std::regex::ECMAScript | std::regex::optimize);
+            }catch(const std::regex_error &){
+                throw std::logic_error("schema error: invalid `pattern`");
+            }
+            node.has_pattern = true;
+        }else if(keyword == "minimum"){
+            node.minimum = KeywordNumber(value, keyword);
+        }else if(keyword == "maximum"){
+            node.maximum = KeywordNumber(value, keyword);
+        }else if(keyword == "exclusiveMinimum"){
+            node.exclusive_minimum = KeywordNumber(value, keyword);
+        }else if(keyword == "exclusiveMaximum"){
+            node.exclusive_maximum = KeywordNumber(value, keyword);
+        }else if(keyword == "minLength"){
+            node.min_length = KeywordCount(value, keyword);
+        }else if(keyword == "maxLength"){
+            node.max_length = KeywordCount(value, keyword);
+        }else if(keyword == "minItems"){
+            node.min_items = KeywordCount(value, keyword);
+        }else if(keyword == "maxItems"){
+            node.max_items = KeywordCount(value, keyword);
+        }else if(keyword == "minProperties"){
+            node.min_properties = KeywordCount(value, keyword);
+        }else if(keyword == "maxProperties"){
+            node.max_properties = KeywordCount(value, keyword);
+        }else if(keyword == "$ref"){
+            throw std::logic_error("schema error: `$ref` is not supported");
+        }else{
+            continue;   //注解与不支持的关键字
+        }
+        constrained = true;
+    }
+
+    for(unsigned long i = 0; i < node.required.size(); i++)
+        node.members[node.required[i]].required = i;
+    node.trivial = !constrained;
+    nodes[index] = std::move(node);
+    return index;
+}
+
+bool Schema::Program::CheckType(const Node &node, unsigned type, SchemaResult &result){
+    if(node.types == 0 || (node.types & type))
+        return true;
+    return Fail(result, "the type does not match");
+}
+
+bool Schema::Program::CheckNumber(const Node &node, double value, SchemaResult &result){
+    if(value < node.minimum)
+        return Fail(result, "the number is less than `minimum`");
+    if(value > node.maximum)
+        return Fail(result, "the number is greater than `maximum`");
+    if(value <= node.exclusive_minimum)
+        return Fail(result, "the number is not greater than `exclusiveMinimum`");
+    if(value >= node.exclusive_maximum)
+        return Fail(result, "the number is not less than `exclusiveMaximum`");
+    return true;
+}
+
+bool Schema::Program::CheckString(const Node &node, const std::string &raw, SchemaResult &result){
+    if(node.min_length > 0 || node.max_length != kUnlimited){
+        unsigned long length = CountCharacters(raw);
+        if(length < node.min_length)
+            return Fail(result, "the string is shorter than `minLength`");
+        if(length > node.max_length)
+            return Fail(result, "the string is longer than `maxLength`");
+    }
+    if(node.has_pattern && !std::regex_search(raw, node.pattern))
+        return Fail(result, "the string does not match `pattern`");
+    return true;
+}
+
+bool Schema::Program::CheckCount(unsigned long count, unsigned long min, unsigned long max,
+                                 const char *what, SchemaResult &result){
+    if(count < min)
+        return Fail(result, std::string("the ") + what + " has too few elements");
+    if(count > max)
+        return Fail(result, std::string("the ") + what + " has too many elements");
+    return true;
+}
+
+//数字按数值比较，1与1.0视为相等
+bool Schema::Program::InEnum(const Node &node, const Json &json){
+    for(unsigned long i = 0; i < node.enum_values.size(); i++){
+        const Json &value = node.enum_values[i];
+        if(json.IsNumber() ? value.IsNumber() && NumberValue(value) == NumberValue(json) : value.Equal(json))
+            return true;
+    }
+    return false;
+}
+
+bool Schema::Program::Check(int index, const Json &json, SchemaResult &result) const{
+    const Node &node = nodes[index];
+    if(node.trivial)
+        return true;
+    if(node.reject)
+        return Fail(result, "the value is rejected by a false schema");
+    if(node.has_enum && !InEnum(node, json))
+        return Fail(result, "the value is not in `enum`");
+
+    switch(json.get_type()){
+    case JsonType::JSON_NULL:
+        return CheckType(node, TYPE_NULL, result);
+    case JsonType::JSON_BOOL:
+        return CheckType(node, TYPE_BOOLEAN, result);
+    case JsonType::JSON_INT:
+    case JsonType::JSON_DOUBLE:{
+        double value = NumberValue(json);
+        return CheckType(node, NumberType(value), result) && CheckNumber(node, value, result);
+    }
+    case JsonType::JSON_STRING:
+        return CheckType(node, TYPE_STRING, result) && CheckString(node, Schema::Text(json), result);
+    case JsonType::JSON_ARRAY:
+        if(!CheckType(node, TYPE_ARRAY, result) ||
+           !CheckCount(json.Size(), node.min_items, node.max_items, "array", result))
+            return false;
+        if(node.items >= 0){
+            for(const Json *it = json.begin(); it != json.end(); it++){
+                if(!Check(node.items, *it, result)){
+                    PrependPath(result, std::to_string(it - json.begin()));
+                    return false;
+                }
+            }
+        }
+        return true;
+    case JsonType::JSON_OBJECT:{
+        if(!CheckType(node, TYPE_OBJECT, result) ||
+           !CheckCount(json.Size(), node.min_properties, node.max_properties, "object", result))
+            return false;
+        const Json::ObjectBuffer &members = Schema::Members(json);
+        for(unsigned long i = 0; i < node.required.size(); i++){
+            if(members.find(node.required[i]) == members.end())
+                return Fail(result, "missing required property `" + node.required[i] + "`");
+        }
+        for(auto it = members.begin(); it != members.end(); it++){
+            auto jt = node.members.find(it->first);
+            if(jt != node.members.end() && jt->second.node >= 0 && !Check(jt->second.node, it->second, result)){
+                PrependPath(result, it->first);
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+bool Schema::Program::Stream(int index, Scanner &scanner, SchemaResult &result) const{
+    const Node &node = nodes[index];
+    if(node.trivial){
+        SkipValue(scanner);
+        return true;
+    }
+    if(node.reject)
+        return Fail(result, "the value is rejected by a false schema");
+    if(node.has_enum)   //enum需要完整的值才能比较
+        return Check(index, BuildValue(scanner, scanner.Scan(), 0), result);
+
+    JsonTokenType token_type = scanner.Scan();
+    switch(token_type){
+    case JsonTokenType::LITERAL_NULL:
+        return CheckType(node, TYPE_NULL, result);
+    case JsonTokenType::LITERAL_TRUE:
+    case JsonTokenType::LITERAL_FALSE:
+        return CheckType(node, TYPE_BOOLEAN, result);
+    case JsonTokenType::VALUE_NUMBER:{
+        double value = scanner.get_number_value();
+        return CheckType(node, NumberType(value), result) && CheckNumber(node, value, result);
+    }
+    case JsonTokenType::VALUE_STRING:
+        return CheckType(node, TYPE_STRING, result) && CheckString(node, scanner.get_string_value_quick(), result);
+    case JsonTokenType::BEGIN_ARRAY:{
+        if(!CheckType(node, TYPE_ARRAY, result))
+            return false;
+        unsigned long count = 0;
+        if(scanner.Scan() != JsonTokenType::END_ARRAY){
+            scanner.Rollback();
+            while(true){
+                if(node.items < 0){
+                    SkipValue(scanner);
+                }else if(!Stream(node.items, scanner, result)){
+                    PrependPath(result, std::to_string(count));
+                    return false;
+                }
+                ++count;
+                token_type = scanner.Scan();
+                if(token_type == JsonTokenType::END_ARRAY)
+                    break;
+                if(token_type != JsonTokenType::VALUE_SEPARATOR)
+                    throw std::runtime_error("format error: invalid json string, expected `,`");
+            }
+        }
+        return CheckCount(count, node.min_items, node.max_items, "array", result);
+    }
+    case JsonTokenType::BEGIN_OBJECT:{
+        if(!CheckType(node, TYPE_OBJECT, result))
+            return false;
+        //记录已出现的必需属性，数量不超过64时不申请内存
+        unsigned long long seen = 0;
+        std::vector<bool> seen_many(node.required.size() > 64 ? node.required.size() : 0);
+        unsigned long count = 0;
+        token_type = scanner.Scan();
+        if(token_type != JsonTokenType::END_OBJECT){
+            while(true){
+                if(token_type != JsonTokenType::VALUE_STRING)
+                    throw std::runtime_error("format error: invalid json string, the key must be a string");
+                auto it = node.members.find(scanner.get_string_value_quick());
+                ExpectToken(scanner, JsonTokenType::NAME_SEPARATOR, "format error: invalid json string, expected `:`");
+                if(it == node.members.end() || it->second.node < 0){
+                    SkipValue(scanner);
+                }else if(!Stream(it->second.node, scanner, result)){
+                    PrependPath(result, it->first);
+                    return false;
+                }
+                if(it != node.members.end() && it->second.required >= 0){
+                    if(seen_many.empty())
+                        seen |= 1ULL << it->second.required;
+                    else
+                        seen_many[it->second.required] = true;
+                }
+                ++count;
+
+                token_type = scanner.Scan();
+                if(token_type == JsonTokenType::END_OBJECT)
+                    break;
+                if(token_type != JsonTokenType::VALUE_SEPARATOR)
+                    throw std::runtime_error("format error: invalid json string, expected `,`");
+                token_type = scanner.Scan();
+            }
+        }
+        if(!CheckCount(count, node.min_properties, node.max_properties, "object", result))
+            return false;
+        for(unsigned long i = 0; i < node.required.size(); i++){
+            if(seen_many.empty() ? !((seen >> i) & 1) : !seen_many[i])
+                return Fail(result, "missing required property `" + node.required[i] + "`");
+        }
+        return true;
+    }
+    case JsonTokenType::END_OF_FILE:
+        throw std::runtime_error("format error: invalid json string, unexpected end");
+    default:
+        throw std::runtime_error("format error: invalid json string");
+    }
+}
+
+Schema::Schema(const Json &schema){
+    std::shared_ptr<Program> program = std::make_shared<Program>();
+    program->Compile(schema);
+    program_ = program;
+}
+
+SchemaResult Schema::Validate(const Json &json) const{
+    SchemaResult result;
+    result.valid = program_->Check(0, json, result);
+    return result;
+}
+
+SchemaResult Schema::ValidateText(const std::string &json_string) const{
+    Scanner scanner(json_string);
+    SchemaResult result;
+    result.valid = program_->Stream(0, scanner, result);
+    if(result.valid && scanner.Scan() != JsonTokenType::END_OF_FILE)
+        throw std::runtime_error("format error: invalid json string, unexpected characters after the value");
+    return result;
+}
+
+const Json::ObjectBuffer &Schema::Members(const Json &json){
+    return *json.value_.object_value;
+}
+
+const std::string &Schema::Text(const Json &json){
+    return *json.value_.string_value;
+}
+
+}
@@ -0,0 +1,206 @@
+#ifndef SIMD_INTERNAL_H
+#define SIMD_INTERNAL_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_PARSER_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace json_parser{
+
+inline unsigned CountTrailingZeros(unsigned mask){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline bool IsStringSpecial(unsigned char c){
+    return c == '\"' || c == '\\' || c < 0x20 || c >= 0x80;
+}
+
+//从pos开始查找字符串中第一个需要单独处理的字节：`"`、`\`、控制字符或非ASCII字节
+inline unsigned long FindStringSpecial(const char *data, unsigned long pos, unsigned long length){
+#ifdef JSON_PARSER_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    while(pos + 16 <= length){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        //有符号比较，小于0x20的同时也包含了最高位为1的非ASCII字节
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmplt_epi8(chunk, space));
+        unsigned mask = _mm_movemask_epi8(special);
+        if(mask)
+            return pos + CountTrailingZeros(mask);
+        pos += 16;
+    }
+#endif
+    while(pos < length && !IsStringSpecial(data[pos]))
+        ++pos;
+    return pos;
+}
+
+inline bool IsWhitespace(char c){
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+//从pos开始查找第一个`"`或`\`
+inline unsigned long FindQuoteOrEscape(const char *data, unsigned long pos, unsigned long length){
+#ifdef JSON_PARSER_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while(pos + 16 <= length){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if(mask)
+            return pos + CountTrailingZeros(mask);
+        pos += 16;
+    }
+#endif
+    while(pos < length && data[pos] != '\"' && data[pos] != '\\')
+        ++pos;
+    return pos;
+}
+
+//从pos开始查找第一个`"`或括号，用于括号匹配跳过整个值
+inline unsigned long FindQuoteOrBracket(const char *data, unsigned long pos, unsigned long length){
+#ifdef JSON_PARSER_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    while(pos + 16 <= length){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        //`[`与`]`置位0x20后分别与`{`和`}`相同，且没有其他字节会与它们相同
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i bracket = _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(bracket, _mm_cmpeq_epi8(chunk, quote)));
+        if(mask)
+            return pos + CountTrailingZeros(mask);
+        pos += 16;
+    }
+#endif
+    while(pos < length && data[pos] != '\"' && (data[pos] | 0x20) != '{' && (data[pos] | 0x20) != '}')
+        ++pos;
+    return pos;
+}
+
+#ifdef JSON_PARSER_SSE2
+//对16个字节分类，得到空白字符与`"`的位掩码
+inline void ClassifyWhitespaceAndQuote(const char *data, unsigned &whitespace, unsigned &quote){
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))),
+                                 _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))));
+    whitespace = _mm_movemask_epi8(blank);
+    quote = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"')));
+}
+#endif
+
+//检查从pos开始的一个多字节UTF-8字符，返回其长度，非法时返回0
+inline unsigned long Utf8SequenceLength(const char *data, unsigned long pos, unsigned long length){
+    const unsigned char *s = reinterpret_cast<const unsigned char *>(data) + pos;
+    unsigned long available = length - pos;
+    unsigned char c = s[0];
+    unsigned long size;
+    unsigned char low = 0x80, high = 0xBF;  //第二个字节的范围，用于排除过长编码与代理区
+    if(c >= 0xC2 && c <= 0xDF){
+        size = 2;
+    }else if(c >= 0xE0 && c <= 0xEF){
+        size = 3;
+        if(c == 0xE0)
+            low = 0xA0;
+        else if(c == 0xED)
+            high = 0x9F;
+    }else if(c >= 0xF0 && c <= 0xF4){
+        size = 4;
+        if(c == 0xF0)
+            low = 0x90;
+        else if(c == 0xF4)
+            high = 0x8F;
+    }else{
+        return 0;
+    }
+
+    if(available < size || s[1] < low || s[1] > high)
+        return 0;
+    for(unsigned long i = 2; i < size; i++){
+        if((s[i] & 0xC0) != 0x80)
+            return 0;
+    }
+    return size;
+}
+
+#ifdef JSON_PARSER_SSE2
+//无符号比较：字节在[low, high]内的位置置为0xFF
+inline __m128i BytesInRange(__m128i chunk, unsigned char low, unsigned char high){
+    __m128i above = _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8((char)low)), chunk);
+    __m128i below = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8((char)high)), chunk);
+    return _mm_and_si128(above, below);
+}
+
+inline unsigned BytesInRangeMask(__m128i chunk, unsigned char low, unsigned char high){
+    return _mm_movemask_epi8(BytesInRange(chunk, low, high));
+}
+#endif
+
+//从pos开始跳过字符串中连续的合法文本（ASCII与完整的多字节UTF-8字符），
+//在`"`、`\`、控制字符或非法的UTF-8序列处停止并返回其位置，调用者再逐字节处理停止处的字节。
+//支持SSE2时每次校验16个字节：先把字节分类为位掩码，再用移位检查首字节与后续字节是否一一对应
+inline unsigned long SkipValidUtf8(const char *data, unsigned long pos, unsigned long length){
+#ifdef JSON_PARSER_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while(pos + 16 <= length){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        unsigned special = _mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            BytesInRange(chunk, 0x00, 0x1F)));
+        unsigned high = _mm_movemask_epi8(chunk);       //最高位为1的字节
+        unsigned continuation = BytesInRangeMask(chunk, 0x80, 0xBF);
+        unsigned lead2 = BytesInRangeMask(chunk, 0xC2, 0xDF);
+        unsigned lead3 = BytesInRangeMask(chunk, 0xE0, 0xEF);
+        unsigned lead4 = BytesInRangeMask(chunk, 0xF0, 0xF4);
+
+        //每个首字节要求其后固定数量的后续字节，超出本块的部分位于16位以上
+        unsigned required = (lead2 << 1) | (lead3 << 1) | (lead3 << 2) | (lead4 << 1) | (lead4 << 2) | (lead4 << 3);
+        unsigned error = ((required ^ continuation) & 0xFFFF) | (high & ~(continuation | lead2 | lead3 | lead4));
+        //第二个字节的范围：排除过长编码、代理区以及超过U+10FFFF的码点
+        error |= (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8((char)0xE0))) << 1) & BytesInRangeMask(chunk, 0x80, 0x9F);
+        error |= (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8((char)0xED))) << 1) & BytesInRangeMask(chunk, 0xA0, 0xBF);
+        error |= (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8((char)0xF0))) << 1) & BytesInRangeMask(chunk, 0x80, 0x8F);
+        error |= (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8((char)0xF4))) << 1) & BytesInRangeMask(chunk, 0x90, 0xBF);
+        unsigned stop = special ? CountTrailingZeros(special) : 16;
+        if(error & ((2u << (stop < 16 ? stop : 15)) - 1))
+            return pos;     //字符串结束之前有错误，交给逐字节的检查以得到一致的出错位置
+        if(special)
+            return pos + stop;
+        //在块末尾被截断的字符留到下一块从其首字节开始检查
+        unsigned truncated = (lead2 & 0x8000) | (lead3 & 0xC000) | (lead4 & 0xE000);
+        pos += truncated ? CountTrailingZeros(truncated) : 16;
+    }
+#endif
+    while(pos < length){
+        unsigned char c = data[pos];
+        if(c < 0x80){
+            if(c == '\"' || c == '\\' || c < 0x20)
+                return pos;
+            ++pos;
+        }else{
+            unsigned long size = Utf8SequenceLength(data, pos, length);
+            if(size == 0)
+                return pos;
+            pos += size;
+        }
+    }
+    return pos;
+}
+}
+
+#endif
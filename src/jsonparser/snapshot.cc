@@ -0,0 +1,36 @@
+#include "jsonparser/snapshot.h"
+#include <atomic>
+
+namespace json_parser{
+
+SnapshotHolder::SnapshotHolder()
+    :snapshot_(Json().Freeze()){
+
+}
+
+SnapshotHolder::SnapshotHolder(const JsonSnapshot& snapshot)
+    :snapshot_(snapshot){
+
+}
+
+JsonSnapshot SnapshotHolder::Load() const{
+    return std::atomic_load(&snapshot_);
+}
+
+void SnapshotHolder::Publish(const JsonSnapshot& snapshot){
+    std::atomic_store(&snapshot_, snapshot);
+}
+
+void SnapshotHolder::Publish(const Json& json){
+    Publish(json.Freeze());
+}
+
+JsonSnapshot SnapshotHolder::Exchange(const JsonSnapshot& snapshot){
+    return std::atomic_exchange(&snapshot_, snapshot);
+}
+
+bool SnapshotHolder::CompareExchange(JsonSnapshot& expected, const JsonSnapshot& desired){
+    return std::atomic_compare_exchange_strong(&snapshot_, &expected, desired);
+}
+
+}
@@ -0,0 +1,259 @@
+#include "jsonparser/validator.h"
+#include "simd_internal.h"
+#include <cstring>
+
+namespace json_parser{
+namespace{
+const unsigned long kMaxDepth = 4096;
+
+bool IsDigit(char c){
+    return c >= '0' && c <= '9';
+}
+
+bool IsHexDigit(char c){
+    return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+//以位栈记录每一层是Json对象还是Json数组，深度有上限，因此无需申请内存
+class Validator{
+public:
+    Validator(const char *data, unsigned long length)
+        : data_(data), length_(length), pos_(0), depth_(0), error_(ErrorCode::OK){}
+
+    ValidateResult Run(){
+        ValidateResult result;
+        result.error = ValidateDocument() ? ErrorCode::OK : error_;
+        result.offset = pos_;
+        return result;
+    }
+
+private:
+    bool Fail(ErrorCode code){
+        error_ = code;
+        return false;
+    }
+
+    bool ValidateDocument();
+    bool ScanKey();
+    bool ScanString();
+    bool ScanNumber();
+    bool ScanLiteral(const char *literal, unsigned long size, ErrorCode code);
+
+    void SkipWhitespace(){
+        while(pos_ < length_ && (data_[pos_] == ' ' || data_[pos_] == '\n' ||
+                                 data_[pos_] == '\r' || data_[pos_] == '\t'))
+            ++pos_;
+    }
+
+    bool Push(bool object){
+        if(depth_ >= kMaxDepth)
+            return Fail(ErrorCode::DEPTH_EXCEEDED);
+        if(object)
+            stack_[depth_ / 8] |= (unsigned char)(1 << (depth_ % 8));
+        else
+            stack_[depth_ / 8] &= (unsigned char)~(1 << (depth_ % 8));
+        ++depth_;
+        return true;
+    }
+
+    bool InObject() const{
+        return (stack_[(depth_ - 1) / 8] >> ((depth_ - 1) % 8)) & 1;
+    }
+
+private:
+    const char *data_;
+    unsigned long length_;
+    unsigned long pos_;
+    unsigned long depth_;
+    ErrorCode error_;
+    unsigned char stack_[kMaxDepth / 8];
+};
+
+bool Validator::ValidateDocument(){
+    SkipWhitespace();
+    while(true){
+        //读取一个值
+        if(pos_ >= length_)
+            return Fail(ErrorCode::UNEXPECTED_END);
+        char c = data_[pos_];
+        if(c == '{' || c == '['){
+            bool object = c == '{';
+            if(!Push(object))
+                return false;
+            ++pos_;
+            SkipWhitespace();
+            if(pos_ >= length_ || data_[pos_] != (object ? '}' : ']')){
+                if(object && !ScanKey())
+                    return false;
+                continue;
+            }
+            ++pos_;
+            --depth_;
+        }else if(c == '\"'){
+            if(!ScanString())
+                return false;
+        }else if(c == '-' || IsDigit(c)){
+            if(!ScanNumber())
+                return false;
+        }else if(c == 't'){
+            if(!ScanLiteral("true", 4, ErrorCode::INVALID_TRUE))
+                return false;
+        }else if(c == 'f'){
+            if(!ScanLiteral("false", 5, ErrorCode::INVALID_FALSE))
+                return false;
+        }else if(c == 'n'){
+            if(!ScanLiteral("null", 4, ErrorCode::INVALID_NULL))
+                return false;
+        }else{
+            return Fail(ErrorCode::INVALID_VALUE);
+        }
+
+        //值结束后，处理若干层的结束符直到遇到`,`
+        while(true){
+            SkipWhitespace();
+            if(depth_ == 0)
+                return pos_ == length_ || Fail(ErrorCode::TRAILING_CHARACTERS);
+            if(pos_ >= length_)
+                return Fail(ErrorCode::UNEXPECTED_END);
+
+            bool object = InObject();
+            c = data_[pos_];
+            if(c == ','){
+                ++pos_;
+                SkipWhitespace();
+                if(object && !ScanKey())
+                    return false;
+                break;
+            }
+            if(c != (object ? '}' : ']'))
+                return Fail(ErrorCode::EXPECTED_COMMA);
+            ++pos_;
+            --depth_;
+        }
+    }
+}
+
+//读取键与其后的`:`
+bool Validator::ScanKey(){
+    if(pos_ >= length_)
+        return Fail(ErrorCode::UNEXPECTED_END);
+    if(data_[pos_] != '\"')
+        return Fail(ErrorCode::EXPECTED_KEY);
+    if(!ScanString())
+        return false;
+    SkipWhitespace();
+    if(pos_ >= length_)
+        return Fail(ErrorCode::UNEXPECTED_END);
+    if(data_[pos_] != ':')
+        return Fail(ErrorCode::EXPECTED_COLON);
+    ++pos_;
+    SkipWhitespace();
+    return true;
+}
+
+bool Validator::ScanString(){
+    ++pos_;
+    while(true){
+        pos_ = FindStringSpecial(data_, pos_, length_);
+        if(pos_ >= length_)
+            return Fail(ErrorCode::MISSING_QUOTE);
+
+        unsigned char c = data_[pos_];
+        if(c == '\"'){
+            ++pos_;
+            return true;
+        }
+        if(c == '\\'){
+            if(pos_ + 1 >= length_)
+                return Fail(ErrorCode::MISSING_QUOTE);
+            switch(data_[pos_ + 1]){
+            case '\"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                pos_ += 2;
+                break;
+            case 'u':
+                for(unsigned long i = 2; i < 6; i++){
+                    if(pos_ + i >= length_ || !IsHexDigit(data_[pos_ + i]))
+                        return Fail(ErrorCode::INVALID_ESCAPE);
+                }
+                pos_ += 6;
+                break;
+            default:
+                return Fail(ErrorCode::INVALID_ESCAPE);
+            }
+        }else if(c < 0x20){
+            return Fail(ErrorCode::INVALID_STRING);
+        }else{
+            //非ASCII文本成段校验，停在原处时说明此处的字符不合法或需要逐字节检查
+            unsigned long end = SkipValidUtf8(data_, pos_, length_);
+            if(end > pos_){
+                pos_ = end;
+                continue;
+            }
+            unsigned long size = Utf8SequenceLength(data_, pos_, length_);
+            if(size == 0)
+                return Fail(ErrorCode::INVALID_UTF8);
+            pos_ += size;
+        }
+    }
+}
+
+//-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool Validator::ScanNumber(){
+    if(data_[pos_] == '-')
+        ++pos_;
+    if(pos_ >= length_ || !IsDigit(data_[pos_]))
+        return Fail(ErrorCode::INVALID_NUMBER);
+    if(data_[pos_] == '0'){
+        ++pos_;
+        if(pos_ < length_ && IsDigit(data_[pos_]))
+            return Fail(ErrorCode::INVALID_NUMBER);     //不允许前导零
+    }else{
+        while(pos_ < length_ && IsDigit(data_[pos_]))
+            ++pos_;
+    }
+
+    if(pos_ < length_ && data_[pos_] == '.'){
+        ++pos_;
+        if(pos_ >= length_ || !IsDigit(data_[pos_]))
+            return Fail(ErrorCode::INVALID_NUMBER);
+        while(pos_ < length_ && IsDigit(data_[pos_]))
+            ++pos_;
+    }
+
+    if(pos_ < length_ && (data_[pos_] == 'e' || data_[pos_] == 'E')){
+        ++pos_;
+        if(pos_ < length_ && (data_[pos_] == '+' || data_[pos_] == '-'))
+            ++pos_;
+        if(pos_ >= length_ || !IsDigit(data_[pos_]))
+            return Fail(ErrorCode::INVALID_NUMBER);
+        while(pos_ < length_ && IsDigit(data_[pos_]))
+            ++pos_;
+    }
+    return true;
+}
+
+bool Validator::ScanLiteral(const char *literal, unsigned long size, ErrorCode code){
+    if(length_ - pos_ < size || std::memcmp(data_ + pos_, literal, size) != 0)
+        return Fail(code);
+    pos_ += size;
+    return true;
+}
+}
+
+ValidateResult Validate(const char *json, unsigned long length){
+    Validator validator(json, length);
+    return validator.Run();
+}
+
+ValidateResult Validate(const std::string &json){
+    return Validate(json.data(), json.size());
+}
+
+}
@@ -0,0 +1,93 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace bind_test{
+struct Address{
+    std::string city;
+    int zip;
+};
+
+struct User{
+    int id;
+    std::string name;
+    double score;
+    bool active;
+    std::vector<int> tags;
+    std::map<std::string, int> counters;
+    Address address;
+};
+
+//字段名的长度与首字母相同，只能靠哈希与比较区分
+struct Similar{
+    int ab;
+    int ac;
+    int ba;
+};
+}
+JSON_BIND(bind_test::Address, city, zip)
+JSON_BIND(bind_test::User, id, name, score, active, tags, counters, address)
+JSON_BIND(bind_test::Similar, ab, ac, ba)
+
+using namespace json_parser;
+using bind_test::User;
+
+//编译期与运行期的哈希一致
+static_assert(BindFieldHash("", 0) == 14695981039346656037ULL, "empty hash");
+static_assert(BindFieldHash("id", 2) != BindFieldHash("di", 2), "order matters");
+
+TEST(bind, HashesAgree){
+    const char *names[] = {"", "id", "name", "a long field name with spaces"};
+    for(const char *name : names)
+        CHECK(BindKeyHash(name) == BindFieldHash(name, std::string(name).size()));
+}
+
+TEST(bind, DecodeEncodeRoundTrip){
+    User user = Decode<User>(
+        "{\"id\":7,\"name\":\"alice\",\"score\":1.5,\"active\":true,\"unknown\":{\"x\":[1,2]},"
+        "\"tags\":[1,2,3],\"counters\":{\"a\":1,\"b\":2},\"address\":{\"city\":\"x\",\"zip\":100}}");
+    CHECK(user.id == 7);
+    CHECK(user.name == "alice");
+    CHECK(user.score == 1.5);
+    CHECK(user.active);
+    CHECK(user.tags.size() == 3 && user.tags[2] == 3);
+    CHECK(user.counters.size() == 2 && user.counters["b"] == 2);
+    CHECK(user.address.city == "x" && user.address.zip == 100);
+
+    User copy = Decode<User>(Encode(user));
+    CHECK(Encode(copy) == Encode(user));
+    CHECK(ParseJsonString(Encode(user))["address"]["zip"].Equal(Json(100)));
+}
+
+TEST(bind, SimilarNamesAreDispatched){
+    bind_test::Similar value = Decode<bind_test::Similar>("{\"ba\":3,\"ac\":2,\"ab\":1,\"bb\":4}");
+    CHECK(value.ab == 1);
+    CHECK(value.ac == 2);
+    CHECK(value.ba == 3);
+}
+
+TEST(bind, IntRangeIsChecked){
+    CHECK(Decode<int>("2147483647") == 2147483647);
+    CHECK(Decode<int>("-2147483648") == -2147483647 - 1);
+    CHECK_THROWS(Decode<int>("2147483648"), std::logic_error);
+    CHECK_THROWS(Decode<int>("-2147483649"), std::logic_error);
+    CHECK_THROWS(Decode<int>("10000000000000000000"), std::logic_error);
+    CHECK_THROWS(Decode<int>("1.5"), std::logic_error);
+    CHECK_THROWS(Decode<User>("{\"id\":4294967296}"), std::logic_error);
+}
+
+TEST(bind, NonFiniteDoubleIsRejected){
+    CHECK(Encode(0.5) == "0.5");
+    CHECK_THROWS(Encode(std::numeric_limits<double>::quiet_NaN()), std::logic_error);
+    CHECK_THROWS(Encode(std::numeric_limits<double>::infinity()), std::logic_error);
+    CHECK_THROWS(Encode(std::vector<double>(1, -std::numeric_limits<double>::infinity())), std::logic_error);
+}
+
+TEST(bind, MalformedInputThrows){
+    CHECK_THROWS(Decode<User>("{\"id\":1,\"unknown\":[1 2]}"), std::runtime_error);
+    CHECK_THROWS(Decode<User>("{\"id\" 1}"), std::runtime_error);
+    CHECK_THROWS(Decode<User>("{\"tags\":[1,2}"), std::runtime_error);
+    CHECK_THROWS(Decode<User>("[1]"), std::logic_error);
+}
@@ -0,0 +1,59 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace json_parser;
+
+//容器足够大时才会缓存文本，测试数据都超过这个长度
+static const char *kDocument =
+    "{\"user\":{\"name\":\"a long enough name for caching\",\"tags\":[\"first\",\"second\",\"third\"]},"
+    "\"items\":[{\"id\":1,\"label\":\"the first item of the list\"},{\"id\":2,\"label\":\"the second item\"}]}";
+
+TEST(cached_text, MatchesToJsonString){
+    Json doc = ParseJsonString(kDocument);
+    CHECK(doc.ToCachedJsonString() == doc.ToJsonString());
+    CHECK(doc.ToCachedJsonString() == doc.ToJsonString());
+}
+
+TEST(cached_text, WriteThroughRootInvalidatesPath){
+    Json doc = ParseJsonString(kDocument);
+    doc.ToCachedJsonString();
+    doc["items"][1]["id"] = 3;
+    CHECK(doc.ToCachedJsonString() == doc.ToJsonString());
+    CHECK(doc.ToCachedJsonString().find("\"id\":3") != std::string::npos);
+}
+
+TEST(cached_text, WriteThroughCopiedChildKeepsCacheFresh){
+    Json doc = ParseJsonString(kDocument);
+    std::string before = doc.ToCachedJsonString();
+    Json user = doc["user"];
+    user["name"] = "changed";
+    CHECK(doc.ToCachedJsonString() == before);
+    CHECK(doc.ToJsonString() == before);
+    CHECK(user.ToCachedJsonString() == user.ToJsonString());
+    CHECK(user.ToCachedJsonString().find("changed") != std::string::npos);
+}
+
+#ifndef JSON_PARSER_SINGLE_THREADED    //单线程计数时不能跨线程共享对象
+TEST(cached_text, ConcurrentOutputOfSnapshot){
+    std::shared_ptr<const Json> snapshot = ParseJsonString(kDocument).Freeze();
+    std::string expected = snapshot->ToJsonString();
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches(0);
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&]{
+            for(int i = 0; i < 500; i++){
+                if(snapshot->ToCachedJsonString() != expected)
+                    ++mismatches;
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+    CHECK(mismatches.load() == 0);
+}
+#endif
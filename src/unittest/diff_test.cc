@@ -0,0 +1,57 @@
+#include "unit_test.h"
+#include "json_parser.h"
+
+using namespace json_parser;
+
+TEST(diff, RoundTrip){
+    const char *pairs[][2] = {
+        {"{\"a\":1,\"b\":[1,2,3]}", "{\"a\":2,\"b\":[1,3],\"c\":null}"},
+        {"[1,2,3,4,5]", "[0,1,3,5,6]"},
+        {"{\"x\":{\"y\":{\"z\":[{\"id\":1},{\"id\":2}]}}}", "{\"x\":{\"y\":{\"z\":[{\"id\":2},{\"id\":3}]}}}"},
+        {"{\"a\":\"~/key\"}", "{\"a/b\":1,\"~c\":2}"},
+        {"[]", "{\"a\":1}"},
+        {"{\"same\":[1,2]}", "{\"same\":[1,2]}"},
+    };
+    for(auto &pair : pairs){
+        Json source = ParseJsonString(pair[0]);
+        Json target = ParseJsonString(pair[1]);
+        Json patch = source.Diff(target);
+        CHECK(source.ApplyPatch(patch).Equal(target));
+    }
+    Json same = ParseJsonString("{\"same\":[1,2]}");
+    CHECK(same.Diff(same).Size() == 0);
+}
+
+TEST(diff, PatchedDocumentGivesSmallPatch){
+    Json doc = ParseJsonString("{\"big\":[1,2,3,4,5,6,7,8,9],\"small\":{\"v\":1}}");
+    Json updated = doc.ApplyPatch(ParseJsonString("[{\"op\":\"replace\",\"path\":\"/small/v\",\"value\":2}]"));
+    Json patch = doc.Diff(updated);
+    CHECK(patch.Size() == 1);
+    CHECK(doc.ApplyPatch(patch).Equal(updated));
+}
+
+//对同一文档反复随机修改，每一步的Diff都应能还原出修改后的文档
+TEST(diff, RandomEditsRoundTrip){
+    Json doc = ParseJsonString("{\"list\":[0,1,2,3,4,5,6,7],\"map\":{\"a\":{\"v\":1},\"b\":[1,2]}}");
+    unsigned seed = 12345;
+    for(int step = 0; step < 200; step++){
+        seed = seed * 1103515245 + 12345;
+        unsigned choice = (seed >> 16) % 4;
+        int size = doc["list"].Size();
+        int index = size ? (int)((seed >> 8) % size) : 0;
+        Json updated = doc;
+        if(choice == 0 || size == 0)
+            updated["list"].Insert(index, Json((int)(seed % 100)));
+        else if(choice == 1)
+            updated["list"].Remove(index);
+        else if(choice == 2)
+            updated["list"][index] = Json((int)(seed % 100));
+        else
+            updated["map"]["a"]["v"] = Json(step);
+
+        Json patch = doc.Diff(updated);
+        CHECK(doc.ApplyPatch(patch).Equal(updated));
+        CHECK(updated.ApplyPatch(updated.Diff(doc)).Equal(doc));
+        doc = updated;
+    }
+}
@@ -0,0 +1,24 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+
+using namespace json_parser;
+
+TEST(format, MinifyKeepsStrings){
+    CHECK(Minify(" { \"a b\" : [ 1 , 2 ] ,\n\t\"c\":\"x  y\" } ") == "{\"a b\":[1,2],\"c\":\"x  y\"}");
+    CHECK(Minify("[\"escaped \\\" quote \", 1]") == "[\"escaped \\\" quote \",1]");
+    CHECK_THROWS(Minify("[\"unterminated]"), std::runtime_error);
+}
+
+TEST(format, PrettifyIndents){
+    CHECK(Prettify("{\"a\":[1,2],\"b\":{},\"c\":[]}", 2) ==
+          "{\n  \"a\": [\n    1,\n    2\n  ],\n  \"b\": {},\n  \"c\": []\n}");
+    CHECK(Prettify(Minify(Prettify("[{\"k\":[true,null]}]"))) == Prettify("[{\"k\":[true,null]}]"));
+}
+
+TEST(format, PrettifyRejectsMismatchedBrackets){
+    CHECK_THROWS(Prettify("[1}"), std::runtime_error);
+    CHECK_THROWS(Prettify("{\"a\":[1,2}]"), std::runtime_error);
+    CHECK_THROWS(Prettify("[1,2]]"), std::runtime_error);
+    CHECK_THROWS(Prettify("{\"a\":[1"), std::runtime_error);
+}
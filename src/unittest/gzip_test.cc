@@ -0,0 +1,81 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#ifdef JSON_PARSER_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace json_parser;
+
+#ifdef JSON_PARSER_ZLIB
+//每次调用写入一个独立的gzip成员
+static void AppendGzipMember(const std::string &path, const std::string &text){
+    gzFile file = gzopen(path.c_str(), "ab");
+    gzwrite(file, text.data(), text.size());
+    gzclose(file);
+}
+
+static std::string Lines(int first, int last){
+    std::string text;
+    for(int i = first; i < last; i++)
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"event\"}\n";
+    return text;
+}
+
+TEST(gzip, NdjsonFromConcatenatedMembers){
+    std::string path = "unit_test_events.ndjson.gz";
+    std::remove(path.c_str());
+    AppendGzipMember(path, Lines(0, 5000));
+    AppendGzipMember(path, Lines(5000, 8000));
+
+    GzipChunkReader reader(path, 4096, 4);
+    NdjsonParser ndjson;
+    long sum = 0;
+    unsigned long count = ndjson.Run(reader, [&](const Json &event){
+        sum += (int)event["id"];
+    });
+    CHECK(count == 8000);
+    CHECK(sum == 8000L * 7999 / 2);
+    std::remove(path.c_str());
+}
+
+//很小的块使一行跨越多个块，CRLF行尾中的\r作为空白被忽略
+TEST(gzip, CrlfLinesSpanningChunks){
+    std::string path = "unit_test_crlf.ndjson.gz";
+    std::remove(path.c_str());
+    AppendGzipMember(path, "{\"id\":1,\"name\":\"first\"}\r\n{\"id\":2,");
+    AppendGzipMember(path, "\"name\":\"second\"}\r\n\r\n");
+
+    GzipChunkReader reader(path, 5, 2);
+    NdjsonParser ndjson;
+    std::string names;
+    unsigned long count = ndjson.Run(reader, [&](const Json &event){
+        names += (std::string)event["name"] + ";";
+    });
+    CHECK(count == 2);
+    CHECK(names == "first;second;");
+    std::remove(path.c_str());
+}
+
+TEST(gzip, TruncatedInputThrows){
+    std::string path = "unit_test_truncated.gz";
+    std::remove(path.c_str());
+    AppendGzipMember(path, Lines(0, 2000));
+    std::ifstream input(path.c_str(), std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream(path.c_str(), std::ios::binary) << data.substr(0, data.size() / 2);
+
+    GzipChunkReader reader(path);
+    const char *chunk = nullptr;
+    CHECK_THROWS(while(reader.Read(chunk) > 0){}, std::runtime_error);
+    std::remove(path.c_str());
+}
+#else
+TEST(gzip, DisabledWithoutZlib){
+    CHECK_THROWS(GzipChunkReader("unit_test_events.ndjson.gz"), std::runtime_error);
+}
+#endif
@@ -0,0 +1,103 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+#include <string>
+
+using namespace json_parser;
+
+static Json ParsePacked(const char *text){
+    Parser parser(text);
+    parser.set_pack_numeric_arrays(true);
+    return parser.Parse();
+}
+
+TEST(iterator, EmptyContainers){
+    Json array = ParseJsonString("[]");
+    Json object = ParseJsonString("{}");
+    const Json &const_array = array;
+    const Json &const_object = object;
+
+    CHECK(array.begin() == array.end());
+    CHECK(const_array.begin() == const_array.end());
+    int count = 0;
+    for(const Json &value : const_array){
+        (void)value;
+        count++;
+    }
+    CHECK(count == 0);
+
+    CHECK(object.Items().empty() && object.Items().size() == 0);
+    CHECK(const_object.Items().begin() == const_object.Items().end());
+}
+
+TEST(iterator, ConstAndMutableArray){
+    Json array = ParseJsonString("[1,\"two\",[3],{\"four\":4}]");
+    const Json &view = array;
+    CHECK(view.end() - view.begin() == 4);
+    CHECK((std::string)view.begin()[1] == "two");
+
+    int index = 0;
+    for(const Json &value : view){
+        CHECK(&value == &view[index]);
+        index++;
+    }
+    CHECK(index == 4);
+
+    for(Json &value : array){
+        value = Json(7);
+    }
+    CHECK(array.ToJsonString() == "[7,7,7,7]");
+    CHECK(array.ToCachedJsonString() == "[7,7,7,7]");
+}
+
+//const遍历展开紧凑数组但保留紧凑存储，非const遍历后不再紧凑
+TEST(iterator, PackedArray){
+    Json packed = ParsePacked("[1,2,3]");
+    const Json &view = packed;
+    int sum = 0;
+    for(const Json &value : view){
+        CHECK(value.IsInt());
+        sum += (int)value;
+    }
+    CHECK(sum == 6);
+    CHECK(packed.GetPackedType() == JsonType::JSON_INT);
+
+    Json doubles = ParsePacked("[0.5,1.5]");
+    for(Json &value : doubles){
+        value = Json((double)value * 2);
+    }
+    CHECK(doubles.GetPackedType() == JsonType::JSON_NULL);
+    CHECK(doubles.ToJsonString() == "[1,3]");
+}
+
+TEST(iterator, ObjectItems){
+    Json object = ParseJsonString("{\"b\":2,\"a\":1,\"c\\n\":3}");
+    const Json &view = object;
+    std::string keys;
+    int sum = 0;
+    for(const auto &item : view.Items()){
+        keys += item.first + ",";
+        sum += (int)item.second;
+    }
+    CHECK(keys == "a,b,c\\n,");     //键按顺序排列且为原文
+    CHECK(sum == 6 && view.Items().size() == 3);
+
+    for(auto &item : object.Items()){
+        item.second = Json((int)item.second + 10);
+    }
+    CHECK(object.ToJsonString() == "{\"a\":11,\"b\":12,\"c\\n\":13}");
+    CHECK(object.ToCachedJsonString() == object.ToJsonString());
+}
+
+TEST(iterator, WrongType){
+    Json object = ParseJsonString("{\"a\":1}");
+    Json array = ParseJsonString("[1]");
+    Json number(1);
+    const Json &const_object = object;
+    const Json &const_array = array;
+    CHECK_THROWS(object.begin(), std::logic_error);
+    CHECK_THROWS(const_object.end(), std::logic_error);
+    CHECK_THROWS(number.begin(), std::logic_error);
+    CHECK_THROWS(array.Items(), std::logic_error);
+    CHECK_THROWS(const_array.Items(), std::logic_error);
+}
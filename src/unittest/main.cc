@@ -0,0 +1,60 @@
+#include "unit_test.h"
+#include <exception>
+#include <iostream>
+#include <vector>
+
+namespace unit_test{
+
+namespace{
+
+struct TestCase{
+    const char *suite;
+    const char *name;
+    TestFunction function;
+};
+
+std::vector<TestCase> &Registry(){
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+int g_failures = 0;
+
+}
+
+Registrar::Registrar(const char *suite, const char *name, TestFunction function){
+    TestCase test = {suite, name, function};
+    Registry().push_back(test);
+}
+
+void Fail(const char *file, int line, const std::string &message){
+    ++g_failures;
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+}
+
+}
+
+//用法：UnitTest [suite]，不指定时运行全部测试组
+int main(int argc, char *argv[]){
+    using namespace unit_test;
+    std::string suite = argc > 1 ? argv[1] : "";
+    int count = 0;
+    for(auto it = Registry().begin(); it != Registry().end(); it++){
+        if(!suite.empty() && suite != it->suite)
+            continue;
+        ++count;
+        int failures = g_failures;
+        try{
+            it->function();
+        }catch(const std::exception &e){
+            Fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        std::cout << (g_failures == failures ? "[ OK ] " : "[FAIL] ")
+                  << it->suite << "." << it->name << std::endl;
+    }
+    if(count == 0){
+        std::cerr << "no test in suite " << suite << std::endl;
+        return 1;
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <new>
+
+using namespace json_parser;
+
+namespace{
+//统计经过的分配，内存来自全局堆
+class CountingResource : public MemoryResource{
+public:
+    CountingResource() : allocated(0), deallocated(0){}
+
+    unsigned long allocated;
+    unsigned long deallocated;
+
+protected:
+    void *DoAllocate(std::size_t bytes, std::size_t){
+        allocated += bytes;
+        return ::operator new(bytes);
+    }
+    void DoDeallocate(void *p, std::size_t bytes, std::size_t){
+        deallocated += bytes;
+        ::operator delete(p);
+    }
+    bool DoIsEqual(const MemoryResource &other) const noexcept{
+        return this == &other;
+    }
+};
+}
+
+TEST(memory_resource, ParserAllocatesBuffersFromResource){
+    CountingResource resource;
+    {
+        Parser parser("{\"a\":[1,2,{\"b\":\"text\"}],\"c\":\"another string\"}");
+        parser.set_memory_resource(&resource);
+        Json json = parser.Parse();
+        CHECK(json.GetMemoryResource() == &resource);
+        CHECK(json["a"].GetMemoryResource() == &resource);
+        CHECK(json["c"].GetMemoryResource() == &resource);
+        CHECK(resource.allocated > 0);
+
+        Json copy = json;
+        copy["a"].Append(Json(3));   //写时复制的容器仍在同一个资源中
+        CHECK(copy["a"].GetMemoryResource() == &resource);
+        CHECK(json.ToJsonString() == "{\"a\":[1,2,{\"b\":\"text\"}],\"c\":\"another string\"}");
+    }
+    CHECK(resource.deallocated == resource.allocated);
+}
+
+TEST(memory_resource, MonotonicPoolHoldsWholeRequest){
+    MonotonicBufferResource pool;
+    {
+        Parser parser("{\"items\":[1,2,3],\"name\":\"a string longer than the small string buffer\"}");
+        parser.set_memory_resource(&pool);
+        Json json = parser.Parse();
+        Json array(JsonType::JSON_ARRAY, &pool);
+        array.Append(json["items"]);
+        CHECK(array.ToJsonString() == "[[1,2,3]]");
+        CHECK((std::string)json["name"] == "a string longer than the small string buffer");
+
+        Json frozen = *json.Freeze();   //快照总是位于默认资源
+        CHECK(frozen.GetMemoryResource() == GetDefaultMemoryResource());
+        CHECK(frozen["items"].GetMemoryResource() == GetDefaultMemoryResource());
+    }
+    pool.Release();
+}
+
+//Append与Insert把整棵子树拷贝到目标容器所在的资源，源资源可以先释放
+TEST(memory_resource, AppendCopiesIntoTargetResource){
+    CountingResource source;
+    CountingResource target;
+    {
+        Json array(JsonType::JSON_ARRAY, &target);
+        Json object(JsonType::JSON_OBJECT, &target);
+        {
+            Parser parser("{\"items\":[[1,2],{\"k\":\"v\"}],\"name\":\"x\"}");
+            parser.set_memory_resource(&source);
+            Json json = parser.Parse();
+            array.Append(json["items"]);
+            array.Insert(0, json);
+            object.Insert("items", json["items"]);
+
+            Json copy;
+            copy.Copy(json, &target);
+            const Json &view = copy;
+            CHECK(view["items"][1]["k"].GetMemoryResource() == &target);
+        }
+        CHECK(source.deallocated == source.allocated);   //源资源中的缓冲区都已归还
+
+        const Json &view = array;
+        CHECK(view[1].GetMemoryResource() == &target);
+        CHECK(view[1][0].GetMemoryResource() == &target);
+        CHECK(view[1][1]["k"].GetMemoryResource() == &target);
+        CHECK(view[0]["items"][0].GetMemoryResource() == &target);
+        CHECK(static_cast<const Json &>(object)["items"][1].GetMemoryResource() == &target);
+        CHECK(array.ToJsonString() == "[{\"items\":[[1,2],{\"k\":\"v\"}],\"name\":\"x\"},[[1,2],{\"k\":\"v\"}]]");
+    }
+    CHECK(target.deallocated == target.allocated);
+}
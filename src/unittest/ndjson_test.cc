@@ -0,0 +1,52 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace json_parser;
+
+static std::vector<std::string> Collect(ChunkReader &reader){
+    std::vector<std::string> values;
+    NdjsonParser ndjson;
+    ndjson.Run(reader, [&](const Json &value){
+        values.push_back(value.ToJsonString());
+    });
+    return values;
+}
+
+//块的大小小于一行时，一行由多个块拼接而成
+TEST(ndjson, LineSpanningChunks){
+    std::string text = "{\"id\":1,\"tags\":[\"a\",\"b\"]}\n[1,2,3]\n\"long string value\"\n42";
+    for(unsigned long chunk_size = 1; chunk_size <= 8; chunk_size++){
+        MemoryChunkReader reader(text, chunk_size);
+        std::vector<std::string> values = Collect(reader);
+        CHECK(values.size() == 4);
+        CHECK(values[0] == "{\"id\":1,\"tags\":[\"a\",\"b\"]}");
+        CHECK(values[2] == "\"long string value\"" && values[3] == "42");
+    }
+}
+
+TEST(ndjson, CrlfAndBlankLines){
+    std::string text = "{\"a\":1}\r\n\r\n  \n[true]\r\n";
+    MemoryChunkReader reader(text, 3);
+    std::vector<std::string> values = Collect(reader);
+    CHECK(values.size() == 2);
+    CHECK(values[0] == "{\"a\":1}" && values[1] == "[true]");
+}
+
+TEST(ndjson, TrailingCharactersThrow){
+    NdjsonParser ndjson;
+    auto ignore = [](const Json &){};
+    CHECK(ndjson.Run("{\"a\":1} \t\r\n2\n", ignore) == 2);
+    CHECK_THROWS(ndjson.Run("{\"a\":1} {\"b\":2}\n", ignore), std::runtime_error);
+    CHECK_THROWS(ndjson.Run("1\n[2] x\n", ignore), std::runtime_error);
+    CHECK_THROWS(ndjson.Run("\"a\"\"b\"", ignore), std::runtime_error);
+    CHECK_THROWS(ndjson.Run("{\"a\":\n1}\n", ignore), std::runtime_error);
+    try{
+        ndjson.Run("[1]]\n", ignore);
+        CHECK(false);
+    }catch(const std::runtime_error &e){
+        CHECK(std::string(e.what()) == ErrorMessage(ErrorCode::TRAILING_CHARACTERS));
+    }
+}
@@ -0,0 +1,134 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace json_parser;
+
+static Json ParsePacked(const char *text){
+    Parser parser(text);
+    parser.set_pack_numeric_arrays(true);
+    return parser.Parse();
+}
+
+TEST(packed_array, IntAndDoubleArrays){
+    Json ints = ParsePacked("[1,-2,3,2147483647]");
+    CHECK(ints.GetPackedType() == JsonType::JSON_INT);
+    NumberSpan<int> span = ints.GetIntSpan();
+    CHECK(span.size() == 4 && span[1] == -2 && span[3] == 2147483647);
+    CHECK_THROWS(ints.GetDoubleSpan(), std::logic_error);
+
+    Json doubles = ParsePacked("[1,2.5,3]");
+    CHECK(doubles.GetPackedType() == JsonType::JSON_DOUBLE);
+    CHECK(doubles.GetDoubleSpan()[0] == 1.0 && doubles.GetDoubleSpan()[1] == 2.5);
+
+    Json large = ParsePacked("[1,4294967296]");    //超出int范围的整数整体存储为double
+    CHECK(large.GetPackedType() == JsonType::JSON_DOUBLE);
+
+    Json mixed = ParsePacked("[1,2,\"x\",[3,4]]");
+    CHECK(mixed.GetPackedType() == JsonType::JSON_NULL);
+    CHECK(mixed[3].GetPackedType() == JsonType::JSON_INT);
+    CHECK(mixed.ToJsonString() == "[1,2,\"x\",[3,4]]");
+    CHECK(ParsePacked("{\"a\":1}").GetPackedType() == JsonType::JSON_NULL);
+}
+
+//紧凑存储对Size、输出、Equal与Hash不可见
+TEST(packed_array, BehavesLikeNormalArray){
+    const char *text = "{\"coordinates\":[[1.5,2.25],[3,4],[-1,0.5]],\"ids\":[7,8,9]}";
+    Json packed = ParsePacked(text);
+    Json normal = ParseJsonString(text);
+    CHECK(packed.ToJsonString() == normal.ToJsonString());
+    CHECK(packed.ToCachedJsonString() == normal.ToJsonString());
+    CHECK(packed.Equal(normal) && normal.Equal(packed));
+    CHECK(packed.Hash() == normal.Hash());
+    CHECK(packed["ids"].Size() == 3);
+    CHECK(packed.Diff(normal).Size() == 0);
+}
+
+//超出int范围的整数存储为double，输出、比较与展开都与普通解析一致
+TEST(packed_array, IntegersOutsideIntRange){
+    const char *text = "[1,3000000000,2,-3000000000]";
+    Json packed = ParsePacked(text);
+    Json normal = ParseJsonString(text);
+    CHECK(packed.GetPackedType() == JsonType::JSON_DOUBLE);
+    CHECK(packed.ToJsonString() == normal.ToJsonString());
+    CHECK(packed.ToJsonString() == "[1,3e+09,2,-3e+09]");
+    CHECK(packed.Equal(normal) && packed.Hash() == normal.Hash());
+    const Json &view = packed;
+    CHECK(view[0].IsInt() && (int)view[0] == 1);
+    CHECK(view[1].IsDouble() && (double)view[1] == 3000000000.0);
+    CHECK(view[3].Equal(normal[3]));
+}
+
+TEST(packed_array, ElementsExpandLazily){
+    Json array = ParsePacked("[10,20,30,40,50,60,70,80]");
+    const Json &view = array;
+    unsigned long before = array.MemoryUsage();
+    CHECK((int)view[2] == 30);
+    CHECK(array.MemoryUsage() > before);    //第一次访问元素时才展开
+    CHECK(array.GetPackedType() == JsonType::JSON_INT);
+    CHECK(array.GetIntSpan()[7] == 80);     //展开后紧凑数据仍然可用
+
+    int sum = 0;
+    for(const Json &element : view)
+        sum += (int)element;
+    CHECK(sum == 360);
+}
+
+#ifndef JSON_PARSER_SINGLE_THREADED    //单线程计数时不能跨线程共享对象
+TEST(packed_array, ConcurrentExpansion){
+    for(int round = 0; round < 20; round++){
+        std::shared_ptr<const Json> snapshot = ParsePacked("[[1,2,3,4,5,6,7,8],[0.5,1.5,2.5]]").Freeze();
+        Json packed = ParsePacked("[1,2,3,4,5,6,7,8]");
+        const Json &view = packed;
+        std::atomic<int> mismatches(0);
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 4; t++){
+            threads.emplace_back([&]{
+                int sum = 0;
+                for(unsigned long i = 0; i < view.Size(); i++)
+                    sum += (int)view[(int)i];
+                if(sum != 36 || (double)(*snapshot)[1][2] != 2.5)
+                    ++mismatches;
+            });
+        }
+        for(auto &thread : threads)
+            thread.join();
+        CHECK(mismatches.load() == 0);
+    }
+}
+#endif
+
+TEST(packed_array, WritesConvertToNormalArray){
+    Json array = ParsePacked("[1,2,3]");
+    Json copy = array;
+    array[0] = "first";
+    CHECK(array.GetPackedType() == JsonType::JSON_NULL);
+    CHECK(array.ToJsonString() == "[\"first\",2,3]");
+    CHECK(copy.GetPackedType() == JsonType::JSON_INT);    //共享的紧凑数组被复制后再修改
+    CHECK(copy.ToJsonString() == "[1,2,3]");
+
+    Json appended = ParsePacked("[1.5]");
+    appended.Append(Json(2));
+    CHECK(appended.ToJsonString() == "[1.5,2]");
+    CHECK(appended.GetPackedType() == JsonType::JSON_NULL);
+}
+
+TEST(packed_array, ReusedParserRepacks){
+    Parser parser;
+    parser.set_pack_numeric_arrays(true);
+    Json json;
+    parser.Reset("[1,2,3]");
+    parser.Parse(json);
+    CHECK(json.GetPackedType() == JsonType::JSON_INT);
+    parser.Reset("[1,\"a\"]");
+    parser.Parse(json);
+    CHECK(json.GetPackedType() == JsonType::JSON_NULL);
+    CHECK(json.ToJsonString() == "[1,\"a\"]");
+    parser.Reset("[0.5,0.25]");
+    parser.Parse(json);
+    CHECK(json.GetPackedType() == JsonType::JSON_DOUBLE);
+    CHECK(json.ToJsonString() == "[0.5,0.25]");
+}
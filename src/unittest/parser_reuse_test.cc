@@ -0,0 +1,85 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <cstdlib>
+#include <new>
+
+using namespace json_parser;
+
+//统计全局分配次数，替换后动态库内的分配同样会被统计
+static unsigned long g_allocations = 0;
+
+void *operator new(std::size_t size){
+    ++g_allocations;
+    void *p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+static const char *kMessage =
+    "{\"id\":12345,\"user\":{\"name\":\"a user name that is long enough\",\"tags\":[\"alpha\",\"beta\",\"gamma\"]},"
+    "\"values\":[1,2,3,4.5,6,7],\"ok\":true,\"none\":null}";
+
+TEST(parser_reuse, ResetParsesSuccessiveDocuments){
+    Parser parser;
+    Json json;
+    const char *texts[] = {
+        "{\"a\":[1,2,3],\"b\":\"x\"}",
+        "[{\"k\":1},{\"k\":2}]",
+        "\"just a string\"",
+        "{\"a\":{\"nested\":[true,false,null]}}",
+        "42",
+        "{}",
+    };
+    for(const char *text : texts){
+        parser.Reset(text);
+        parser.Parse(json);
+        CHECK(json.Equal(ParseJsonString(text)));
+    }
+}
+
+TEST(parser_reuse, SteadyStateMakesNoAllocation){
+    Parser parser;
+    Json json;
+    for(int i = 0; i < 3; i++){     //预热，让缓冲区达到所需的容量
+        parser.Reset(kMessage);
+        parser.Parse(json);
+    }
+    unsigned long before = g_allocations;
+    for(int i = 0; i < 10; i++){
+        parser.Reset(kMessage);
+        parser.Parse(json);
+    }
+    CHECK(g_allocations == before);
+    CHECK(json.Equal(ParseJsonString(kMessage)));
+}
+
+//被其他对象共享的部分不会被原地覆盖
+TEST(parser_reuse, SharedBuffersAreNotOverwritten){
+    Parser parser(kMessage);
+    Json json;
+    parser.Parse(json);
+    Json kept = json;
+    Json user = json["user"];
+    std::string text = kept.ToJsonString();
+
+    parser.Reset("{\"id\":1,\"user\":{\"name\":\"other\",\"tags\":[]},\"values\":[],\"ok\":false,\"none\":null}");
+    parser.Parse(json);
+    CHECK(kept.ToJsonString() == text);
+    CHECK((std::string)user["name"] == "a user name that is long enough");
+    CHECK((int)json["id"] == 1);
+    CHECK(json["user"]["tags"].Size() == 0);
+}
+
+TEST(parser_reuse, FailedParseLeavesParserUsable){
+    Parser parser("{\"a\":[1,2");
+    Json json;
+    CHECK_THROWS(parser.Parse(json), std::runtime_error);
+    parser.Reset(kMessage);
+    parser.Parse(json);
+    CHECK(json.Equal(ParseJsonString(kMessage)));
+}
@@ -0,0 +1,101 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+
+using namespace json_parser;
+
+TEST(patch, ApplyPatchOperations){
+    Json doc = ParseJsonString("{\"a\":{\"b\":[1,2,3]},\"c\":\"x\"}");
+    Json patch = ParseJsonString(
+        "[{\"op\":\"add\",\"path\":\"/a/b/1\",\"value\":9},"
+        "{\"op\":\"remove\",\"path\":\"/c\"},"
+        "{\"op\":\"replace\",\"path\":\"/a/b/0\",\"value\":{\"k\":true}},"
+        "{\"op\":\"copy\",\"from\":\"/a/b\",\"path\":\"/d\"},"
+        "{\"op\":\"move\",\"from\":\"/d/3\",\"path\":\"/e\"},"
+        "{\"op\":\"test\",\"path\":\"/e\",\"value\":3}]");
+    Json updated = doc.ApplyPatch(patch);
+    CHECK(updated.Equal(ParseJsonString(
+        "{\"a\":{\"b\":[{\"k\":true},9,2,3]},\"d\":[{\"k\":true},9,2],\"e\":3}")));
+    CHECK(doc.ToJsonString() == "{\"a\":{\"b\":[1,2,3]},\"c\":\"x\"}");
+}
+
+TEST(patch, FailedPatchLeavesDocument){
+    Json doc = ParseJsonString("{\"a\":[1]}");
+    CHECK_THROWS(doc.ApplyPatch(ParseJsonString(
+        "[{\"op\":\"add\",\"path\":\"/b\",\"value\":1},{\"op\":\"test\",\"path\":\"/a/0\",\"value\":2}]")),
+        std::logic_error);
+    CHECK_THROWS(doc.ApplyPatch(ParseJsonString("[{\"op\":\"remove\",\"path\":\"/a/5\"}]")), std::logic_error);
+    CHECK_THROWS(doc.ApplyPatch(ParseJsonString("[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/a/0\"}]")), std::logic_error);
+    CHECK(doc.ToJsonString() == "{\"a\":[1]}");
+}
+
+//写入的值被深拷贝，结果与补丁互不共享
+TEST(patch, ValuesAreNotSharedWithPatch){
+    Json doc = ParseJsonString("{\"a\":1}");
+    Json patch = ParseJsonString("[{\"op\":\"add\",\"path\":\"/b\",\"value\":{\"k\":[1,2]}}]");
+    Json updated = doc.ApplyPatch(patch);
+    CHECK(patch[0]["value"].UseCount() == 1);
+    CHECK(updated["b"].UseCount() == 1);
+    patch[0]["value"]["k"][0] = 5;
+    CHECK(updated.ToJsonString() == "{\"a\":1,\"b\":{\"k\":[1,2]}}");
+
+    Json merge = ParseJsonString("{\"b\":{\"k\":[3]},\"c\":[4]}");
+    Json merged = doc.ApplyMergePatch(merge);
+    CHECK(merged.ToJsonString() == "{\"a\":1,\"b\":{\"k\":[3]},\"c\":[4]}");
+    CHECK(merge["c"].UseCount() == 1);
+    merge["b"]["k"][0] = 5;
+    CHECK(merged.ToJsonString() == "{\"a\":1,\"b\":{\"k\":[3]},\"c\":[4]}");
+
+    Json whole = ParseJsonString("[1,2]");
+    Json replaced = doc.ApplyMergePatch(whole);
+    CHECK(replaced.Equal(whole));
+    CHECK(whole.UseCount() == 1);
+}
+
+//嵌套的容器同样不与补丁共享
+TEST(patch, NestedValuesAreDeepCopied){
+    Json doc = ParseJsonString("{\"a\":1}");
+    Json patch = ParseJsonString("[{\"op\":\"add\",\"path\":\"/x\",\"value\":{\"n\":{\"m\":[1]}}}]");
+    Json updated = doc.ApplyPatch(patch);
+    const Json &source = patch;
+    Json inner = source[0]["value"]["n"];
+    CHECK(inner.UseCount() == 2);   //只被补丁与inner持有
+    Json leaf = source[0]["value"]["n"]["m"];
+    CHECK(leaf.UseCount() == 2);
+    CHECK(updated["x"]["n"]["m"].Equal(leaf));
+
+    Json replace = ParseJsonString("[{\"op\":\"replace\",\"path\":\"\",\"value\":{\"n\":[1]}}]");
+    Json whole = doc.ApplyPatch(replace);
+    CHECK(whole.ToJsonString() == "{\"n\":[1]}");
+    Json whole_inner = static_cast<const Json &>(whole)["n"];
+    CHECK(whole_inner.UseCount() == 2);
+
+    Json merge = ParseJsonString("{\"a\":{\"n\":{\"m\":[2]}},\"b\":[{\"c\":[3]}]}");
+    Json merged = doc.ApplyMergePatch(merge);
+    const Json &merge_source = merge;
+    Json merge_inner = merge_source["a"]["n"];
+    Json merge_element = merge_source["b"][0];
+    CHECK(merge_inner.UseCount() == 2);
+    CHECK(merge_element.UseCount() == 2);
+    CHECK(merged.ToJsonString() == "{\"a\":{\"n\":{\"m\":[2]}},\"b\":[{\"c\":[3]}]}");
+
+    //写入的值位于文档所在的内存资源，补丁的内存池可以先于结果释放
+    MonotonicBufferResource pool;
+    Json pooled;
+    {
+        Parser parser("[{\"op\":\"add\",\"path\":\"/y\",\"value\":{\"n\":[\"a string longer than the small string buffer\"]}}]");
+        parser.set_memory_resource(&pool);
+        Json pooled_patch = parser.Parse();
+        pooled = doc.ApplyPatch(pooled_patch);
+    }
+    CHECK(pooled["y"]["n"].GetMemoryResource() == GetDefaultMemoryResource());
+    pool.Release();
+    CHECK(pooled.ToJsonString() == "{\"a\":1,\"y\":{\"n\":[\"a string longer than the small string buffer\"]}}");
+}
+
+TEST(patch, MergePatch){
+    Json doc = ParseJsonString("{\"a\":\"b\",\"c\":{\"d\":\"e\",\"f\":\"g\"}}");
+    Json merged = doc.ApplyMergePatch(ParseJsonString("{\"a\":\"z\",\"c\":{\"f\":null}}"));
+    CHECK(merged.Equal(ParseJsonString("{\"a\":\"z\",\"c\":{\"d\":\"e\"}}")));
+    CHECK(doc.ToJsonString() == "{\"a\":\"b\",\"c\":{\"d\":\"e\",\"f\":\"g\"}}");
+}
@@ -0,0 +1,49 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace json_parser;
+
+static std::string ReadAll(ChunkReader &reader){
+    std::string output;
+    const char *data = nullptr;
+    unsigned long size;
+    while((size = reader.Read(data)) > 0)
+        output.append(data, size);
+    return output;
+}
+
+TEST(reader, MemoryChunkReaderSplitsInput){
+    std::string text = "{\"a\":[1,2,3],\"b\":\"text\"}";
+    MemoryChunkReader reader(text, 5);
+    const char *data = nullptr;
+    CHECK(reader.Read(data) == 5);
+    CHECK(std::string(data, 5) == "{\"a\":");
+    CHECK(ReadAll(reader) == text.substr(5));
+}
+
+#ifndef _WIN32
+TEST(reader, MappedFileReaderReadsWholeFile){
+    std::string path = "unit_test_reader.json";
+    std::string text;
+    for(int i = 0; i < 10000; i++)
+        text += "{\"id\":" + std::to_string(i) + "}\n";
+    std::ofstream(path.c_str(), std::ios::binary) << text;
+
+    MappedFileReader reader(path, 4096);
+    CHECK(reader.size() == text.size());
+    CHECK(ReadAll(reader) == text);
+    std::remove(path.c_str());
+
+    std::ofstream(path.c_str(), std::ios::binary);
+    MappedFileReader empty(path);
+    CHECK(empty.size() == 0);
+    CHECK(ReadAll(empty).empty());
+    std::remove(path.c_str());
+
+    CHECK_THROWS(MappedFileReader("unit_test_missing.json"), std::runtime_error);
+}
+#endif
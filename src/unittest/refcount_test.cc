@@ -0,0 +1,44 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <utility>
+
+using namespace json_parser;
+
+//两种计数策略下引用计数的增减一致
+TEST(refcount, CopiesShareOneCounter){
+    Json a = ParseJsonString("{\"x\":[1,2],\"s\":\"text\"}");
+    CHECK(a.UseCount() == 1);
+    {
+        Json b = a;
+        Json c;
+        c = b;
+        CHECK(a.UseCount() == 3);
+        c = c;
+        CHECK(a.UseCount() == 3);
+    }
+    CHECK(a.UseCount() == 1);
+
+    Json moved = std::move(a);
+    CHECK(moved.UseCount() == 2);     //Json没有移动构造，移动即拷贝
+}
+
+//写时复制与拷贝出的缓冲区从1开始计数，不继承原缓冲区的计数
+TEST(refcount, CopiedBuffersStartAtOne){
+    Json a = ParseJsonString("[1,2,3]");
+    Json b = a;
+    b.Append(4);
+    CHECK(a.UseCount() == 1);
+    CHECK(b.UseCount() == 1);
+
+    Json c = a;
+    Json d;
+    d.Copy(c);
+    CHECK(a.UseCount() == 2);
+    CHECK(d.UseCount() == 1);
+
+    Json object = ParseJsonString("{\"k\":{\"n\":1}}");
+    Json inner = static_cast<const Json &>(object)["k"];
+    CHECK(inner.UseCount() == 2);
+    object.Remove("k");
+    CHECK(inner.UseCount() == 1);
+}
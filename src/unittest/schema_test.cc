@@ -0,0 +1,76 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+
+using namespace json_parser;
+
+static Schema MakeSchema(){
+    return Schema(ParseJsonString(
+        "{\"type\":\"object\",\"required\":[\"id\"],"
+        "\"properties\":{\"id\":{\"type\":\"integer\",\"minimum\":1},\"tags\":{\"type\":\"array\"}}}"));
+}
+
+TEST(schema, ValidateTextMatchesValidate){
+    Schema schema = MakeSchema();
+    const char *texts[] = {
+        "{\"id\":1,\"tags\":[1,\"a\"],\"extra\":{\"x\":[1,2]}}",
+        "{\"id\":0}",
+        "{\"tags\":[]}",
+        "{\"id\":2,\"tags\":{}}",
+    };
+    for(const char *text : texts){
+        SchemaResult tree = schema.Validate(ParseJsonString(text));
+        SchemaResult stream = schema.ValidateText(text);
+        CHECK(tree.valid == stream.valid);
+        CHECK(tree.path == stream.path);
+    }
+}
+
+//未受约束的子树被跳过时也要检查语法
+TEST(schema, SkippedValuesMustBeWellFormed){
+    Schema schema = MakeSchema();
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":[1 2}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":[}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":{\"a\" 1}}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":{\"a\":1,}}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":{1:2}}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"tags\":[[1],]}"), std::runtime_error);
+    CHECK_THROWS(schema.ValidateText("{\"id\":1,\"x\":[[1]"), std::runtime_error);
+
+    Schema any(ParseJsonString("{}"));
+    CHECK_THROWS(any.ValidateText("[}"), std::runtime_error);
+    CHECK_THROWS(any.ValidateText("{\"a\":[1,{\"b\":2]}}"), std::runtime_error);
+    CHECK(any.ValidateText("{\"a\":[1,{\"b\":[]},{}],\"c\":\"]\"}").valid);
+}
+
+TEST(schema, DeeplyNestedSkippedValue){
+    Schema any(ParseJsonString("{}"));
+    std::string text(100000, '[');
+    text += std::string(100000, ']');
+    CHECK(any.ValidateText(text).valid);
+}
+
+//超出int范围的整数在两种校验方式中都作为double比较
+TEST(schema, EnumWithLargeIntegers){
+    Schema schema(ParseJsonString("{\"enum\":[3000000000,5,[-3000000000]]}"));
+    const char *texts[] = {"3000000000", "5", "[-3000000000]", "-1294967296", "[1294967296]", "3000000001"};
+    for(const char *text : texts){
+        SchemaResult tree = schema.Validate(ParseJsonString(text));
+        SchemaResult stream = schema.ValidateText(text);
+        CHECK(tree.valid == stream.valid);
+    }
+    CHECK(schema.ValidateText("3000000000").valid);
+    CHECK(!schema.ValidateText("-1294967296").valid);
+}
+
+//enum需要构建完整的值，嵌套深度与解析器一样有上限
+TEST(schema, DeeplyNestedEnumValue){
+    Schema schema(ParseJsonString("{\"enum\":[[[1]]]}"));
+    CHECK(schema.ValidateText("[[1]]").valid);
+    std::string text(100000, '[');
+    text += std::string(100000, ']');
+    CHECK_THROWS(schema.ValidateText(text), std::runtime_error);
+    std::string limit(4096, '[');
+    limit += std::string(4096, ']');
+    CHECK(!schema.ValidateText(limit).valid);
+}
@@ -0,0 +1,159 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace json_parser;
+
+//经非const接口修改共享的容器时，其他共享者与它们的缓存都不受影响
+
+TEST(sharing, WriteThroughCopiedChildKeepsHashFresh){
+    const char *text = "{\"x\":{\"k\":1},\"y\":[1,2]}";
+    Json a = ParseJsonString(text);
+    unsigned long hash = a.Hash();
+    Json child = a["x"];
+    child["k"] = 2;
+    CHECK((int)child["k"] == 2);
+    CHECK(a.Hash() == hash);
+    CHECK(a.Equal(ParseJsonString(text)));
+    CHECK(a.ToJsonString() == "{\"x\":{\"k\":1},\"y\":[1,2]}");
+}
+
+TEST(sharing, WriteThroughCopiedRootKeepsOriginal){
+    Json a = ParseJsonString("{\"x\":{\"k\":[1,2,3]}}");
+    a.Hash();
+    Json b = a;
+    b["x"]["k"][0] = 9;
+    CHECK(a.ToJsonString() == "{\"x\":{\"k\":[1,2,3]}}");
+    CHECK(b.ToJsonString() == "{\"x\":{\"k\":[9,2,3]}}");
+    CHECK(!a.Equal(b));
+    CHECK(a.Hash() != b.Hash());
+    b["x"]["k"][0] = 1;
+    CHECK(a.Equal(b));
+    CHECK(a.Hash() == b.Hash());
+}
+
+TEST(sharing, DeduplicatedSubtreesAreIndependent){
+    Json d = ParseJsonString("{\"a\":{\"city\":\"x\"},\"b\":{\"city\":\"x\"}}");
+    d.Deduplicate();
+    d["a"]["city"] = "y";
+    const Json &view = d;
+    CHECK((std::string)view["a"]["city"] == "y");
+    CHECK((std::string)view["b"]["city"] == "x");
+}
+
+//去重不会改写与快照共享的容器
+TEST(sharing, DeduplicateCopyOfSnapshot){
+    Json doc = ParseJsonString("{\"a\":{\"city\":\"x\",\"tags\":[1,2]},\"b\":{\"city\":\"x\",\"tags\":[1,2]},\"c\":[[1,2],[1,2]]}");
+    std::shared_ptr<const Json> snapshot = doc.Freeze();
+    std::string text = snapshot->ToJsonString();
+    Json copy = *snapshot;
+    copy.Deduplicate();
+    CHECK(!((*snapshot)["a"] == (*snapshot)["b"]));
+    CHECK(!((*snapshot)["c"][0] == (*snapshot)["c"][1]));
+    CHECK(snapshot->ToJsonString() == text);
+
+    const Json &view = copy;
+    CHECK(view["a"] == view["b"]);
+    CHECK(view["c"][0] == view["c"][1]);
+    CHECK(view["a"]["tags"] == view["c"][0]);
+    CHECK(copy.Equal(*snapshot));
+    CHECK(copy.MemoryUsage() < snapshot->MemoryUsage());
+}
+
+//只被自身持有的容器原地去重，不产生新的容器
+TEST(sharing, DeduplicateExclusiveInPlace){
+    Json doc = ParseJsonString("{\"a\":[{\"k\":1},{\"k\":1}],\"b\":{\"k\":1}}");
+    unsigned long before = doc.MemoryUsage();
+    const Json *array = &static_cast<const Json &>(doc)["a"];
+    doc.Deduplicate();
+    const Json &view = doc;
+    CHECK(&view["a"] == array);
+    CHECK(view["a"][0] == view["b"] && view["a"][1] == view["b"]);
+    CHECK(doc.MemoryUsage() < before);
+    CHECK(doc.ToJsonString() == "{\"a\":[{\"k\":1},{\"k\":1}],\"b\":{\"k\":1}}");
+}
+
+//哈希都已缓存时先比较哈希，结果与逐个比较一致
+TEST(sharing, EqualWithCachedHashes){
+    Json a = ParseJsonString("{\"x\":[1,2,3],\"y\":{\"z\":null}}");
+    Json b = ParseJsonString("{\"x\":[1,2,3],\"y\":{\"z\":null}}");
+    Json c = ParseJsonString("{\"x\":[1,2,4],\"y\":{\"z\":null}}");
+    a.Hash();
+    b.Hash();
+    c.Hash();
+    CHECK(a.Equal(b) && b.Equal(a));
+    CHECK(!a.Equal(c) && !c.Equal(a));
+    c["x"][2] = 3;
+    CHECK(a.Equal(c));
+    c.Hash();
+    CHECK(a.Equal(c));
+}
+
+TEST(sharing, IterationCopiesSharedContainers){
+    Json array = ParseJsonString("[1,2,3]");
+    Json copy = array;
+    for(Json &element : copy)
+        element = 0;
+    CHECK(array.ToJsonString() == "[1,2,3]");
+    CHECK(copy.ToJsonString() == "[0,0,0]");
+
+    Json object = ParseJsonString("{\"a\":1,\"b\":2}");
+    Json other = object;
+    for(auto &item : other.Items())
+        item.second = 0;
+    CHECK(object.ToJsonString() == "{\"a\":1,\"b\":2}");
+    CHECK(other.ToJsonString() == "{\"a\":0,\"b\":0}");
+}
+
+TEST(sharing, ExclusiveContainersAreNotCopied){
+    Json a = ParseJsonString("{\"x\":[1,2]}");
+    const Json *element = &a["x"][0];
+    a["x"][0] = 5;
+    CHECK(&a["x"][0] == element);
+    CHECK(a.ToJsonString() == "{\"x\":[5,2]}");
+}
+
+TEST(sharing, FrozenSnapshotIsNotModifiedThroughCopies){
+    Json doc = ParseJsonString("{\"a\":{\"k\":1},\"b\":[1,2]}");
+    std::shared_ptr<const Json> snapshot = doc.Freeze();
+    std::string text = snapshot->ToJsonString();
+
+    Json inner = (*snapshot)["a"];
+    inner["k"] = 2;
+    Json array = (*snapshot)["b"];
+    for(Json &element : array)
+        element = 0;
+    CHECK(snapshot->ToJsonString() == text);
+    CHECK(snapshot->Equal(doc));
+    CHECK((int)inner["k"] == 2);
+}
+
+#ifndef JSON_PARSER_SINGLE_THREADED    //单线程计数时不能跨线程共享对象
+TEST(sharing, FrozenSnapshotConcurrentCopies){
+    Json doc = ParseJsonString("{\"a\":{\"k\":1},\"b\":[1,2,3]}");
+    std::shared_ptr<const Json> snapshot = doc.Freeze();
+    std::string text = snapshot->ToJsonString();
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches(0);
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&, t]{
+            for(int i = 0; i < 2000; i++){
+                Json inner = (*snapshot)["a"];
+                inner["k"] = t;
+                Json array = (*snapshot)["b"];
+                array[0] = i;
+                if((int)inner["k"] != t || (int)array[0] != i || snapshot->ToJsonString() != text)
+                    ++mismatches;
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+    CHECK(mismatches.load() == 0);
+    CHECK(snapshot->ToJsonString() == text);
+}
+#endif
@@ -0,0 +1,20 @@
+#include "jsonparser/static_json.h"
+
+//每个宏选择一种格式错误，对应的目标应无法通过编译
+#if defined(STATIC_JSON_TRAILING_COMMA)
+static constexpr auto kDocument = JSON_STATIC("[1,2,]");
+#elif defined(STATIC_JSON_MISSING_QUOTE)
+static constexpr auto kDocument = JSON_STATIC(R"({"key": "value})");
+#elif defined(STATIC_JSON_TRAILING_CHARACTERS)
+static constexpr auto kDocument = JSON_STATIC("{} {}");
+#elif defined(STATIC_JSON_INVALID_LITERAL)
+static constexpr auto kDocument = JSON_STATIC("[tru]");
+#elif defined(STATIC_JSON_NODE_COUNT)
+static constexpr json_parser::StaticDocument<2> kDocument(R"({"a":1,"b":2})");
+#else
+static constexpr auto kDocument = JSON_STATIC("null");
+#endif
+
+int main(){
+    return kDocument.Root().IsNull() ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "../unit_test.h"
+#include "jsonparser/static_json.h"
+#include "json_parser.h"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace json_parser;
+
+//README中的示例
+static constexpr auto kDefaults = JSON_STATIC(R"({"port": 8080, "hosts": ["a", "b"]})");
+static_assert((int)kDefaults["port"] == 8080);
+static_assert(kDefaults["hosts"].Size() == 2);
+static_assert(std::string_view(kDefaults["hosts"][1]) == "b");
+
+static constexpr auto kValues = JSON_STATIC(R"(
+    {"int": -12, "double": 0.25, "big": 4294967296, "bool": true, "null": null,
+     "escaped": "a\"b", "empty": [], "nested": {"list": [1, [2, 3], {"x": 4}]}, "int": 7}
+)");
+static_assert(kValues.Root().IsObject());
+static_assert(kValues["int"].IsInt() && (int)kValues["int"] == 7);     //重复的键以后出现的为准
+static_assert(kValues.Root().Size() == 9);
+static_assert((double)kValues["double"] == 0.25);
+static_assert(kValues["big"].IsDouble() && (double)kValues["big"] == 4294967296.0);
+static_assert((bool)kValues["bool"] && kValues["null"].IsNull());
+static_assert(std::string_view(kValues["escaped"]) == "a\\\"b");      //保留原文不解码转义
+static_assert(kValues["empty"].IsArray() && kValues["empty"].Size() == 0);
+static_assert((int)kValues["nested"]["list"][1][1] == 3);
+static_assert((int)kValues["nested"]["list"][2]["x"] == 4);
+static_assert(kValues.Root().FindKey("nested") && !kValues.Root().FindKey("missing"));
+
+constexpr int SumInts(StaticJson json){
+    int sum = 0;
+    for(StaticJson element : json)
+        sum += element.IsInt() ? (int)element : SumInts(element);
+    return sum;
+}
+static_assert(SumInts(kValues["nested"]["list"]) == 10);
+
+constexpr std::size_t Keys(StaticJson json){
+    std::size_t length = 0;
+    for(StaticJson member : json)
+        length += member.get_key().size();
+    return length;
+}
+static constexpr auto kKeys = JSON_STATIC(R"({"ab":1,"cde":2})");
+static_assert(Keys(kKeys.Root()) == 5);
+static_assert(StaticNodeCount("[1,[2,3],{\"a\":null}]") == 7);
+
+//在运行时使用StaticParser，格式错误抛出std::runtime_error
+static std::size_t CountNodes(const char *text){
+    return StaticParser(text).Parse();
+}
+
+TEST(static_json, ErrorCases){
+    CHECK(CountNodes("[1,2]") == 3);
+    CHECK_THROWS(CountNodes("[1,2,]"), std::runtime_error);
+    CHECK_THROWS(CountNodes("[1 2]"), std::runtime_error);
+    CHECK_THROWS(CountNodes("{\"a\" 1}"), std::runtime_error);
+    CHECK_THROWS(CountNodes("{1:2}"), std::runtime_error);
+    CHECK_THROWS(CountNodes("\"abc"), std::runtime_error);
+    CHECK_THROWS(CountNodes("nul"), std::runtime_error);
+    CHECK_THROWS(CountNodes("{} x"), std::runtime_error);
+    CHECK_THROWS(CountNodes(""), std::runtime_error);
+    try{
+        CountNodes("[1] 2");
+        CHECK(false);
+    }catch(const std::runtime_error &e){
+        CHECK(std::string(e.what()) == ErrorMessage(ErrorCode::TRAILING_CHARACTERS));
+    }
+}
+
+TEST(static_json, TypeErrors){
+    StaticJson root = kValues.Root();
+    CHECK_THROWS((int)root["double"], std::logic_error);
+    CHECK_THROWS(static_cast<std::string_view>(root["int"]), std::logic_error);
+    CHECK_THROWS(root["missing"], std::logic_error);
+    CHECK_THROWS(root["empty"][0], std::logic_error);
+    CHECK_THROWS(root["int"].Size(), std::logic_error);
+}
+
+//与运行时解析的结果一致
+TEST(static_json, ToJsonMatchesParser){
+    Json config = kDefaults.ToJson();
+    CHECK(config.Equal(ParseJsonString(R"({"port": 8080, "hosts": ["a", "b"]})")));
+    config["port"] = 9090;
+    CHECK((int)config["port"] == 9090 && (int)kDefaults["port"] == 8080);
+
+    Json values = kValues.ToJson();
+    CHECK((int)values["int"] == 7 && (int)values["nested"]["list"][2]["x"] == 4);
+    CHECK(values["escaped"].ToJsonString() == "\"a\\\"b\"");
+    CHECK(values["big"].ToJsonString() == ParseJsonString("4294967296").ToJsonString());
+}
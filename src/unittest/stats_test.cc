@@ -0,0 +1,66 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <string>
+
+using namespace json_parser;
+
+TEST(stats, CountsTokens){
+    const std::string text = "{\"list\":[1,2.5,[true,null]],\"name\":\"abc\"}";
+    ParseStats stats;
+    Json json = ParseJsonString(text, &stats);
+    CHECK(json.ToJsonString() == text);
+    if(!ParseStats::Enabled()){
+        CHECK(stats.bytes_consumed == 0 && stats.number_count == 0 && stats.allocations == 0);
+        return;     //未开启统计时不记录
+    }
+    CHECK(stats.bytes_consumed == text.size());
+    CHECK(stats.TokenCount(JsonTokenType::BEGIN_OBJECT) == 1);
+    CHECK(stats.TokenCount(JsonTokenType::BEGIN_ARRAY) == 2);
+    CHECK(stats.TokenCount(JsonTokenType::VALUE_NUMBER) == 2);
+    CHECK(stats.TokenCount(JsonTokenType::LITERAL_TRUE) == 1);
+    CHECK(stats.TokenCount(JsonTokenType::LITERAL_NULL) == 1);
+    CHECK(stats.number_count == 2);
+    CHECK(stats.max_depth == 3);
+    CHECK(stats.string_bytes >= 3);
+    CHECK(stats.allocations > 0 && stats.bytes_allocated > 0);
+    CHECK(stats.total_seconds >= stats.scan_seconds);
+}
+
+//复用同一个统计对象时各项累加
+TEST(stats, AccumulatesAcrossParses){
+    ParseStats stats;
+    Parser parser("[1,[2]]", &stats);
+    Json json;
+    parser.Parse(json);
+    parser.Reset("  {\"a\":3}");
+    parser.Parse(json);
+    if(!ParseStats::Enabled()){
+        CHECK(stats.bytes_consumed == 0);
+        return;
+    }
+    CHECK(stats.bytes_consumed == 7 + 9);
+    CHECK(stats.number_count == 3);
+    CHECK(stats.TokenCount(JsonTokenType::BEGIN_ARRAY) == 2);
+    CHECK(stats.TokenCount(JsonTokenType::BEGIN_OBJECT) == 1);
+    CHECK(stats.max_depth == 2);
+
+    stats.Reset();
+    parser.Reset("[]");
+    parser.Parse(json);
+    CHECK(stats.bytes_consumed == 2 && stats.number_count == 0 && stats.max_depth == 1);
+}
+
+TEST(stats, MemoryUsage){
+    CHECK(Json(1).MemoryUsage() == 0);
+    CHECK(Json(std::string(100, 'x')).MemoryUsage() > 100);
+
+    Json child = ParseJsonString("{\"city\":\"somewhere\",\"tags\":[1,2,3,4]}");
+    Json shared(JsonType::JSON_OBJECT);
+    shared["a"] = child;
+    shared["b"] = child;    //两个键共享同一个容器，只计算一次
+    Json copied = ParseJsonString(shared.ToJsonString());
+    CHECK(shared.Equal(copied));
+    CHECK(shared.MemoryUsage() < copied.MemoryUsage());
+    CHECK(copied.MemoryUsage() > 2 * child.MemoryUsage());
+    CHECK(shared.MemoryUsage() > child.MemoryUsage());
+}
@@ -0,0 +1,81 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <stdexcept>
+#include <string>
+
+using namespace json_parser;
+
+namespace{
+struct ErrorCase{
+    const char *text;
+    ErrorCode error;
+    unsigned long offset;
+};
+
+//offset为出错记号的起始位置
+const ErrorCase kErrors[] = {
+    {"[1 2]", ErrorCode::EXPECTED_COMMA, 3},
+    {"[1,2", ErrorCode::EXPECTED_COMMA, 4},
+    {"{\"a\" 1}", ErrorCode::EXPECTED_COLON, 5},
+    {"{1:2}", ErrorCode::EXPECTED_KEY, 1},
+    {"{\"a\":1,}", ErrorCode::EXPECTED_KEY, 7},
+    {"tru", ErrorCode::INVALID_TRUE, 0},
+    {"nul", ErrorCode::INVALID_NULL, 0},
+    {"[fals]", ErrorCode::INVALID_FALSE, 1},
+    {"  \"abc", ErrorCode::MISSING_QUOTE, 2},
+    {"{\"a\":[1,{\"b\":2]}", ErrorCode::EXPECTED_COMMA, 14},
+};
+}
+
+TEST(try_parse, ReportsErrorCodeAndOffset){
+    for(const ErrorCase &error : kErrors){
+        Json json(JsonType::JSON_ARRAY);
+        ParseResult result = TryParseJsonString(error.text, json);
+        CHECK(!result);
+        CHECK(result.error == error.error);
+        CHECK(result.offset == error.offset);
+        CHECK(json.IsNull());
+    }
+}
+
+//抛出异常的接口建立在TryParse之上，消息与错误码一致
+TEST(try_parse, MatchesThrowingParse){
+    for(const ErrorCase &error : kErrors){
+        std::string message;
+        try{
+            ParseJsonString(error.text);
+        }catch(const std::runtime_error &e){
+            message = e.what();
+        }
+        CHECK(message == ErrorMessage(error.error));
+    }
+}
+
+TEST(try_parse, SuccessReportsConsumedBytes){
+    const std::string text = " {\"a\" : [ 1 , 2 ] } ";
+    Json json;
+    ParseResult result = TryParseJsonString(text, json);
+    CHECK(result);
+    CHECK(result.error == ErrorCode::OK);
+    CHECK(result.offset == text.size() - 1);    //读取到值的末尾，之后的空白不计入
+    CHECK(json.Equal(ParseJsonString("{\"a\":[1,2]}")));
+}
+
+TEST(try_parse, ParserIsNoexceptAndReusable){
+    Parser parser("[1,");
+    Json json;
+    static_assert(noexcept(parser.TryParse(json)), "TryParse must not throw");
+    CHECK(parser.TryParse(json).error == ErrorCode::EXPECTED_COMMA);
+    parser.Reset("{\"ok\":true}");
+    CHECK(parser.TryParse(json));
+    CHECK((bool)json["ok"]);
+}
+
+TEST(try_parse, DepthLimit){
+    std::string deep(100000, '[');
+    deep += std::string(100000, ']');
+    Json json;
+    ParseResult result = TryParseJsonString(deep, json);
+    CHECK(result.error == ErrorCode::DEPTH_EXCEEDED);
+    CHECK(json.IsNull());
+}
@@ -0,0 +1,43 @@
+#ifndef JSONPARSER_UNIT_TEST_H
+#define JSONPARSER_UNIT_TEST_H
+
+#include <string>
+
+//极简的测试注册与断言，TEST定义的函数在静态初始化时注册到所属的测试组
+namespace unit_test{
+
+typedef void (*TestFunction)();
+
+struct Registrar{
+    Registrar(const char *suite, const char *name, TestFunction function);
+};
+
+void Fail(const char *file, int line, const std::string &message);
+
+}
+
+#define TEST(suite, name) \
+    static void suite##_##name(); \
+    static unit_test::Registrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition) \
+    do{ \
+        if(!(condition)) \
+            unit_test::Fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+    }while(0)
+
+//expression应抛出type类型的异常
+#define CHECK_THROWS(expression, type) \
+    do{ \
+        bool thrown = false; \
+        try{ \
+            expression; \
+        }catch(const type &){ \
+            thrown = true; \
+        } \
+        if(!thrown) \
+            unit_test::Fail(__FILE__, __LINE__, "CHECK_THROWS(" #expression ", " #type ")"); \
+    }while(0)
+
+#endif
@@ -0,0 +1,94 @@
+#include "unit_test.h"
+#include "json_parser.h"
+#include <string>
+
+using namespace json_parser;
+
+namespace{
+//逐个码点解码的参考实现，返回第一个非法字节的位置，合法时返回npos
+std::string::size_type FirstInvalidUtf8(const std::string &text){
+    std::string::size_type i = 0;
+    while(i < text.size()){
+        unsigned char c = text[i];
+        unsigned long size;
+        unsigned code;
+        if(c < 0x80){
+            ++i;
+            continue;
+        }else if(c >= 0xC0 && c < 0xE0){
+            size = 2;
+            code = c & 0x1F;
+        }else if(c >= 0xE0 && c < 0xF0){
+            size = 3;
+            code = c & 0x0F;
+        }else if(c >= 0xF0 && c < 0xF8){
+            size = 4;
+            code = c & 0x07;
+        }else{
+            return i;
+        }
+        if(i + size > text.size())
+            return i;
+        for(unsigned long k = 1; k < size; k++){
+            unsigned char next = text[i + k];
+            if((next & 0xC0) != 0x80)
+                return i;
+            code = (code << 6) | (next & 0x3F);
+        }
+        static const unsigned kMinCode[] = {0, 0, 0x80, 0x800, 0x10000};
+        if(code < kMinCode[size] || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+            return i;
+        i += size;
+    }
+    return std::string::npos;
+}
+
+const char *kPieces[] = {
+    "a", "bc", " ", "\xC3\xA9", "\xE4\xB8\xAD", "\xE6\x96\x87", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF",
+    "\xC0\xAF", "\xC1", "\x80", "\xBF", "\xE0\x80\x80", "\xE0\xA0", "\xED\xA0\x80", "\xF4\x90\x80\x80",
+    "\xF5", "\xFF", "\xC3", "\xE4\xB8", "\xF0\x9F\x98",
+};
+}
+
+TEST(validator, Utf8Accepted){
+    std::string text = "\"";
+    for(int i = 0; i < 200; i++)
+        text += "中文文本 with ASCII \xF0\x9F\x98\x80 \xC3\xA9";
+    text += "\"";
+    CHECK(Validate(text));
+    CHECK(Validate("[\"" + text.substr(1, text.size() - 2) + "\\n\", \"\xE4\xB8\xAD\"]"));
+}
+
+//随机拼接合法与非法的片段，结果（包括出错的偏移）应与参考实现一致
+TEST(validator, Utf8MatchesReference){
+    unsigned seed = 42;
+    const unsigned valid_pieces = 8;
+    const unsigned pieces = sizeof(kPieces) / sizeof(kPieces[0]);
+    for(int round = 0; round < 5000; round++){
+        std::string content;
+        seed = seed * 1103515245 + 12345;
+        unsigned count = (seed >> 16) % 60;
+        bool corrupt = round % 3 == 0;
+        for(unsigned i = 0; i < count; i++){
+            seed = seed * 1103515245 + 12345;
+            unsigned index = (seed >> 16) % (corrupt ? pieces : valid_pieces);
+            content += kPieces[index];
+        }
+        std::string text = "[\"" + content + "\"]";
+        ValidateResult result = Validate(text);
+        std::string::size_type invalid = FirstInvalidUtf8(content);
+        if(invalid == std::string::npos){
+            CHECK(result);
+        }else{
+            CHECK(result.error == ErrorCode::INVALID_UTF8);
+            CHECK(result.offset == invalid + 2);
+        }
+    }
+}
+
+TEST(validator, StringErrors){
+    CHECK(Validate("\"\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\x01\"").error == ErrorCode::INVALID_STRING);
+    CHECK(Validate("\"\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\\x\"").error == ErrorCode::INVALID_ESCAPE);
+    CHECK(Validate("\"\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8").error == ErrorCode::INVALID_UTF8);
+    CHECK(Validate("\"\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD\xE4\xB8\xAD").error == ErrorCode::MISSING_QUOTE);
+}